@@ -0,0 +1,407 @@
+// throughput and fragmentation of every Horreum allocator against the system allocator
+// build with `make bench` (Linux, glibc), run from the repository root
+// the results are written as CSV rows (benchmark,allocator,threads,metric,value) to stdout, or to the file given as first argument
+
+#include "horreum/Horreum.hpp"
+#include "horreum/SizeClassAllocator.hpp"
+#include "horreum/PoolAllocator.hpp"
+#include "horreum/StackAllocator.hpp"
+#include "horreum/SharedStackAllocator.hpp"
+#include "horreum/FrameAllocator.hpp"
+#include "horreum/VirtualArena.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static constexpr uint32_t BATCH_SIZE = 1024;
+static constexpr uint32_t FIXED_ROUND_COUNT = 4096; // batches per thread
+static constexpr size_t FIXED_SIZE = 64;
+
+static constexpr uint32_t MIXED_SLOT_COUNT = 4096;
+static constexpr uint32_t MIXED_OPERATION_COUNT = 4 * 1024 * 1024; // per thread
+
+static constexpr uint32_t FRAGMENTATION_SLOT_COUNT = 16384;
+static constexpr uint32_t FRAGMENTATION_STEP_COUNT = 4 * 1024 * 1024;
+static constexpr uint32_t FOOTPRINT_SAMPLE_PERIOD = 4096;
+
+static constexpr size_t STACK_SIZE = BATCH_SIZE * (FIXED_SIZE + 16);
+
+static FILE* output = stdout;
+
+static uint32_t nextRandom(uint32_t &state){
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static void report(const char* benchmark, const char* allocator, uint32_t threads, const char* metric, double value){
+	fprintf(output, "%s,%s,%u,%s,%.3f\n", benchmark, allocator, threads, metric, value);
+}
+
+// ====================================== allocators
+
+// one instance per thread, the thread safe allocators share their state between the instances
+class Subject{
+	public:
+		virtual ~Subject(){}
+		virtual void* allocate(size_t size) = 0;
+		virtual void release(void*, size_t){} // give one block back
+		virtual void reset(){} // give every block back at once, after each batch
+};
+
+class SystemSubject : public Subject{
+	public:
+		void* allocate(size_t size) override {return ::malloc(size);}
+		void release(void* ptr, size_t) override {::free(ptr);}
+};
+
+class SizeClassSubject : public Subject{
+	public:
+		void* allocate(size_t size) override {return SizeClassAllocator::malloc(size);}
+		void release(void* ptr, size_t) override {SizeClassAllocator::free(ptr);}
+};
+
+// the HRM_MALLOC path, with the category accounting
+class HorreumSubject : public Subject{
+	public:
+		void* allocate(size_t size) override {return Horreum::malloc(size);}
+		void release(void* ptr, size_t) override {Horreum::free(ptr);}
+};
+
+// the HRM_MALLOC path with HORREUM_ALLOC_LOG, the sample rate is set before each run
+class HorreumLogSubject : public Subject{
+	public:
+		void* allocate(size_t size) override {return Horreum::mallocLog(size, __FILE__, __func__, __LINE__);}
+		void release(void* ptr, size_t) override {Horreum::freeLog(ptr);}
+};
+
+static PoolAllocator* sharedPool = nullptr;
+
+class PoolSubject : public Subject{
+	public:
+		void* allocate(size_t) override {return sharedPool->getElement();}
+		void release(void* ptr, size_t) override {sharedPool->restoreElement(ptr);}
+};
+
+class MagazineSubject : public Subject{
+	public:
+		MagazineSubject() : magazine{*sharedPool}{}
+		void* allocate(size_t) override {return magazine.getElement();}
+		void release(void* ptr, size_t) override {magazine.restoreElement(ptr);}
+
+	private:
+		PoolAllocator::Magazine magazine;
+};
+
+class StackSubject : public Subject{
+	public:
+		StackSubject() : stack{STACK_SIZE}{}
+		void* allocate(size_t size) override {return stack.push(size, 16);}
+		void reset() override {stack.clear();}
+
+	private:
+		StackAllocator stack;
+};
+
+class SharedStackSubject : public Subject{
+	public:
+		SharedStackSubject() : stack{STACK_SIZE}{}
+		void* allocate(size_t size) override {
+			left = !left;
+			return left ? stack.pushLeft(size, 16) : stack.pushRight(size, 16);
+		}
+		void reset() override {
+			stack.setCurrentUsedSizeLeft(0);
+			stack.setCurrentUsedSizeRight(0);
+		}
+
+	private:
+		SharedStackAllocator stack;
+		bool left = false;
+};
+
+class FrameSubject : public Subject{
+	public:
+		FrameSubject() : frames{STACK_SIZE, 2}{}
+		void* allocate(size_t size) override {return frames.push(size, 16);}
+		void reset() override {frames.beginFrame();}
+
+	private:
+		FrameAllocator frames;
+};
+
+class ArenaSubject : public Subject{
+	public:
+		ArenaSubject() : arena{64 * 1024 * 1024}{}
+		void* allocate(size_t size) override {return arena.push(size, 16);}
+		void reset() override {arena.clear();}
+
+	private:
+		VirtualArena arena;
+};
+
+template<typename T>
+static Subject* create(){
+	return new T();
+}
+
+struct Allocator{
+	const char* name;
+	Subject* (*create)();
+	bool general; // any size in any order, used by the mixed and fragmentation benchmarks
+	uint32_t sampleRate; // for the allocation log, 0 otherwise
+};
+
+static const Allocator allocators[] = {
+	{"system", &create<SystemSubject>, true, 0},
+	{"size_class", &create<SizeClassSubject>, true, 0},
+	{"hrm", &create<HorreumSubject>, true, 0},
+	{"hrm_log", &create<HorreumLogSubject>, true, Horreum::DEFAULT_SAMPLE_RATE},
+	{"hrm_log_all", &create<HorreumLogSubject>, true, 1},
+	{"pool", &create<PoolSubject>, false, 0},
+	{"pool_magazine", &create<MagazineSubject>, false, 0},
+	{"stack", &create<StackSubject>, false, 0},
+	{"shared_stack", &create<SharedStackSubject>, false, 0},
+	{"frame", &create<FrameSubject>, false, 0},
+	{"arena", &create<ArenaSubject>, false, 0},
+};
+
+// ====================================== throughput
+
+// BATCH_SIZE blocks of FIXED_SIZE bytes allocated then released in reverse order, or reset at once
+static void runFixed(const Allocator &allocator, uint32_t){
+	Subject* subject = allocator.create();
+	void* blocks[BATCH_SIZE];
+
+	for (uint32_t round=0; round<FIXED_ROUND_COUNT; round++){
+		for (uint32_t i=0; i<BATCH_SIZE; i++){
+			blocks[i] = subject->allocate(FIXED_SIZE);
+			*static_cast<char*>(blocks[i]) = static_cast<char>(i);
+		}
+		for (uint32_t i=BATCH_SIZE; i>0; i--){
+			subject->release(blocks[i - 1], FIXED_SIZE);
+		}
+		subject->reset();
+	}
+
+	delete subject;
+}
+
+// random sizes (16 bytes to 4 KB) and random lifetimes, each operation allocates an empty slot or frees a full one
+static void runMixed(const Allocator &allocator, uint32_t seed){
+	Subject* subject = allocator.create();
+	void** slots = new void*[MIXED_SLOT_COUNT]();
+	size_t* sizes = new size_t[MIXED_SLOT_COUNT];
+	uint32_t state = seed;
+
+	for (uint32_t i=0; i<MIXED_OPERATION_COUNT; i++){
+		uint32_t index = nextRandom(state) % MIXED_SLOT_COUNT;
+
+		if (slots[index]){
+			subject->release(slots[index], sizes[index]);
+			slots[index] = nullptr;
+		} else {
+			uint32_t r = nextRandom(state);
+			sizes[index] = (r & 7) == 0 ? 1024 + r % 3072 : 16 + r % 240;
+			slots[index] = subject->allocate(sizes[index]);
+			*static_cast<char*>(slots[index]) = 0;
+		}
+	}
+
+	for (uint32_t i=0; i<MIXED_SLOT_COUNT; i++){
+		if (slots[i]) subject->release(slots[i], sizes[i]);
+	}
+
+	delete[] slots;
+	delete[] sizes;
+	delete subject;
+}
+
+struct ThreadData{
+	const Allocator* allocator;
+	void (*kernel)(const Allocator&, uint32_t);
+	uint32_t seed;
+};
+
+static void* runThread(void* data){
+	ThreadData* thread = static_cast<ThreadData*>(data);
+	thread->kernel(*thread->allocator, thread->seed);
+	SizeClassAllocator::flushThreadCache();
+	return nullptr;
+}
+
+// return the wall time in nanoseconds
+static double runThreads(const Allocator &allocator, void (*kernel)(const Allocator&, uint32_t), uint32_t threadCount){
+	pthread_t* threads = new pthread_t[threadCount];
+	ThreadData* data = new ThreadData[threadCount];
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i=0; i<threadCount; i++){
+		data[i] = {&allocator, kernel, 0x9E3779B9u + i * 7919u};
+		pthread_create(&threads[i], nullptr, &runThread, &data[i]);
+	}
+	for (uint32_t i=0; i<threadCount; i++){
+		pthread_join(threads[i], nullptr);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	delete[] threads;
+	delete[] data;
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static void benchmarkThroughput(const char* benchmark, const Allocator &allocator, void (*kernel)(const Allocator&, uint32_t), double operationCount, uint32_t threadCount){
+	if (allocator.sampleRate) Horreum::setSampleRate(allocator.sampleRate);
+
+	// warm up, so every allocator starts with its pools filled
+	runThreads(allocator, kernel, 1);
+
+	for (uint32_t threads : {1u, threadCount}){
+		double time = runThreads(allocator, kernel, threads);
+		double operations = operationCount * threads;
+		report(benchmark, allocator.name, threads, "ns_per_op", time / operations);
+		report(benchmark, allocator.name, threads, "mops_per_s", operations / time * 1000.0);
+	}
+}
+
+// ====================================== fragmentation
+
+// the memory the process got from the system for the heap, spans of the size class allocator included
+static size_t getHeapFootprint(){
+	#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+		struct mallinfo2 info = mallinfo2();
+		return info.arena + info.hblkhd;
+	#else
+		struct mallinfo info = mallinfo();
+		return static_cast<size_t>(static_cast<unsigned int>(info.arena)) + static_cast<size_t>(static_cast<unsigned int>(info.hblkhd));
+	#endif
+}
+
+// random sizes with short and long lifetimes, then 90% of the survivors freed
+// the peak and residual footprints are compared with the bytes actually requested
+static void runFragmentation(const Allocator &allocator){
+	Subject* subject = allocator.create();
+	void** slots = new void*[FRAGMENTATION_SLOT_COUNT]();
+	size_t* sizes = new size_t[FRAGMENTATION_SLOT_COUNT];
+	uint32_t* deaths = new uint32_t[FRAGMENTATION_SLOT_COUNT];
+	uint32_t state = 0x2545F491u;
+
+	size_t baseFootprint = getHeapFootprint();
+	size_t liveBytes = 0;
+	size_t peakBytes = 0;
+	size_t peakFootprint = 0;
+
+	for (uint32_t step=0; step<FRAGMENTATION_STEP_COUNT; step++){
+		uint32_t index = nextRandom(state) % FRAGMENTATION_SLOT_COUNT;
+
+		if (!slots[index]){
+			uint32_t r = nextRandom(state) % 100;
+			if (r < 60) sizes[index] = 16 + nextRandom(state) % 113;
+			else if (r < 90) sizes[index] = 128 + nextRandom(state) % 897;
+			else sizes[index] = 1024 + nextRandom(state) % (15 * 1024);
+
+			// one block out of eight lives a hundred times longer
+			uint32_t lifetime = nextRandom(state) % 8 == 0 ? 100 * FRAGMENTATION_SLOT_COUNT : FRAGMENTATION_SLOT_COUNT;
+			deaths[index] = step + 1 + nextRandom(state) % lifetime;
+			slots[index] = subject->allocate(sizes[index]);
+			memset(slots[index], 0, sizes[index]);
+			liveBytes += sizes[index];
+			if (liveBytes > peakBytes) peakBytes = liveBytes;
+		} else if (step >= deaths[index]){
+			subject->release(slots[index], sizes[index]);
+			slots[index] = nullptr;
+			liveBytes -= sizes[index];
+		}
+
+		if (step % FOOTPRINT_SAMPLE_PERIOD == 0){
+			size_t footprint = getHeapFootprint() - baseFootprint;
+			if (footprint > peakFootprint) peakFootprint = footprint;
+		}
+	}
+
+	for (uint32_t i=0; i<FRAGMENTATION_SLOT_COUNT; i++){
+		if (slots[i] && i % 10 != 0){
+			subject->release(slots[i], sizes[i]);
+			slots[i] = nullptr;
+			liveBytes -= sizes[i];
+		}
+	}
+	malloc_trim(0);
+	size_t residualFootprint = getHeapFootprint() - baseFootprint;
+
+	report("fragmentation", allocator.name, 1, "peak_requested_bytes", static_cast<double>(peakBytes));
+	report("fragmentation", allocator.name, 1, "peak_footprint_bytes", static_cast<double>(peakFootprint));
+	report("fragmentation", allocator.name, 1, "peak_overhead", static_cast<double>(peakFootprint) / peakBytes);
+	report("fragmentation", allocator.name, 1, "residual_requested_bytes", static_cast<double>(liveBytes));
+	report("fragmentation", allocator.name, 1, "residual_footprint_bytes", static_cast<double>(residualFootprint));
+	report("fragmentation", allocator.name, 1, "residual_overhead", liveBytes ? static_cast<double>(residualFootprint) / liveBytes : 0.0);
+
+	for (uint32_t i=0; i<FRAGMENTATION_SLOT_COUNT; i++){
+		if (slots[i]) subject->release(slots[i], sizes[i]);
+	}
+	delete[] slots;
+	delete[] sizes;
+	delete[] deaths;
+	delete subject;
+}
+
+// each fragmentation run gets a fresh heap, in a child process forked before any other benchmark
+static void benchmarkFragmentation(const Allocator &allocator){
+	fflush(output);
+
+	pid_t pid = fork();
+	if (pid < 0){
+		fprintf(stderr, "failed to fork the fragmentation run of %s\n", allocator.name);
+		return;
+	}
+	if (pid == 0){
+		if (allocator.sampleRate) Horreum::setSampleRate(allocator.sampleRate);
+		runFragmentation(allocator);
+		fflush(output);
+		_exit(0);
+	}
+	waitpid(pid, nullptr, 0);
+}
+
+// ====================================== main
+
+int main(int argc, char** argv){
+	if (argc > 1){
+		output = fopen(argv[1], "w");
+		if (!output){
+			fprintf(stderr, "failed to open %s\n", argv[1]);
+			return 1;
+		}
+	}
+
+	uint32_t threadCount = std::thread::hardware_concurrency();
+	if (threadCount < 2) threadCount = 2;
+	if (threadCount > 8) threadCount = 8;
+
+	fprintf(output, "benchmark,allocator,threads,metric,value\n");
+
+	for (const Allocator &allocator : allocators){
+		if (allocator.general) benchmarkFragmentation(allocator);
+	}
+
+	sharedPool = new PoolAllocator(FIXED_SIZE, BATCH_SIZE * threadCount);
+
+	for (const Allocator &allocator : allocators){
+		benchmarkThroughput("fixed", allocator, &runFixed, static_cast<double>(FIXED_ROUND_COUNT) * BATCH_SIZE, threadCount);
+	}
+
+	for (const Allocator &allocator : allocators){
+		if (allocator.general) benchmarkThroughput("mixed", allocator, &runMixed, MIXED_OPERATION_COUNT, threadCount);
+	}
+
+	delete sharedPool;
+	if (output != stdout) fclose(output);
+	return 0;
+}
@@ -0,0 +1,112 @@
+// up to 16 threads taking and dropping references to hot, already loaded assets
+// build with `make bench`, run from the repository root
+// the results are written as CSV rows (benchmark,threads,metric,value) to stdout, or to the file given as first argument
+
+#include "Odin.hpp"
+#include <chrono>
+#include <cstdio>
+#include <pthread.h>
+
+static constexpr uint32_t HOT_ASSET_COUNT = 64;
+static constexpr uint32_t LOOKUP_COUNT = 1024 * 1024; // per thread
+static constexpr uint32_t MAX_THREAD_COUNT = 16;
+
+static FILE* output = stdout;
+static char names[HOT_ASSET_COUNT][32];
+static Odin::AssetID ids[HOT_ASSET_COUNT];
+
+struct Sprite{
+	int id;
+};
+
+class SpriteFactory : public Odin::Factory{
+	public:
+		void init(){}
+		size_t getTypeHash() const override {return typeid(Sprite).hash_code();}
+		void* create(const Odin::Data &data) override {
+			int id;
+			data.get(id);
+			return new Sprite{id};
+		}
+		void destroy(void* asset) override {delete static_cast<Sprite*>(asset);}
+};
+
+struct ThreadData{
+	uint32_t seed;
+	uint32_t hot; // the count of names the thread picks from
+	bool byID; // look up the hashed names instead of the names
+	uint64_t checksum;
+};
+
+static void* lookupThread(void* data){
+	ThreadData* thread = static_cast<ThreadData*>(data);
+	uint32_t state = thread->seed;
+
+	for (uint32_t i=0; i<LOOKUP_COUNT; i++){
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		// a cache hit, the reference is dropped at once
+		int id = static_cast<int>(state % thread->hot);
+		Odin::Reference<Sprite> sprite = thread->byID ? Odin::getAsset<Sprite>(ids[id], id) : Odin::getAsset<Sprite>(names[id], id);
+		thread->checksum += sprite->id;
+	}
+	return nullptr;
+}
+
+static void run(const char* benchmark, uint32_t hot, bool byID){
+	for (uint32_t threadCount=1; threadCount<=MAX_THREAD_COUNT; threadCount*=2){
+		pthread_t threads[MAX_THREAD_COUNT];
+		ThreadData data[MAX_THREAD_COUNT];
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i=0; i<threadCount; i++){
+			data[i] = {0x9E3779B9u + i * 7919u, hot, byID, 0};
+			pthread_create(&threads[i], nullptr, &lookupThread, &data[i]);
+		}
+		for (uint32_t i=0; i<threadCount; i++){
+			pthread_join(threads[i], nullptr);
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		double time = std::chrono::duration<double, std::nano>(end - start).count();
+		double lookups = static_cast<double>(LOOKUP_COUNT) * threadCount;
+		fprintf(output, "%s,%u,ns_per_lookup,%.3f\n", benchmark, threadCount, time / lookups);
+		fprintf(output, "%s,%u,mlookups_per_s,%.3f\n", benchmark, threadCount, lookups / time * 1000.0);
+	}
+}
+
+int main(int argc, char** argv){
+	if (argc > 1){
+		output = fopen(argv[1], "w");
+		if (!output){
+			fprintf(stderr, "failed to open %s\n", argv[1]);
+			return 1;
+		}
+	}
+
+	Odin::initialize(1);
+	Odin::registerFactory<SpriteFactory>();
+
+	// the assets are pinned by a reference each, so the lookups never load nor destroy
+	Odin::Reference<Sprite> pinned[HOT_ASSET_COUNT];
+	for (uint32_t i=0; i<HOT_ASSET_COUNT; i++){
+		snprintf(names[i], sizeof(names[i]), "sprites/hot_%u.png", i);
+		ids[i] = Odin::hashName(names[i]);
+		pinned[i] = Odin::getAsset<Sprite>(names[i], static_cast<int>(i));
+	}
+
+	fprintf(output, "benchmark,threads,metric,value\n");
+	run("hot_64", HOT_ASSET_COUNT, false);
+	run("hot_1", 1, false);
+	run("hot_64_id", HOT_ASSET_COUNT, true);
+
+	for (uint32_t i=0; i<HOT_ASSET_COUNT; i++){
+		pinned[i].reset();
+	}
+	Odin::shutdown();
+
+	if (output != stdout) fclose(output);
+	return 0;
+}
@@ -0,0 +1,144 @@
+// compare the size class allocator with the system allocator on the allocation mix of the engine
+// build with `make bench`, run from the repository root
+
+#include "horreum/SizeClassAllocator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+
+static constexpr uint32_t SLOT_COUNT = 4096;
+static constexpr uint32_t OPERATION_COUNT = 4 * 1024 * 1024;
+static constexpr uint32_t THREAD_COUNT = 4;
+
+struct Allocator{
+	const char* name;
+	void* (*malloc)(size_t);
+	void* (*realloc)(void*, size_t);
+	void (*free)(void*);
+};
+
+static const Allocator allocators[] = {
+	{"system", &::malloc, &::realloc, &::free},
+	{"size class", &SizeClassAllocator::malloc, &SizeClassAllocator::realloc, &SizeClassAllocator::free},
+};
+
+static uint32_t nextRandom(uint32_t &state){
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// the sizes seen in the engine
+// 45% ECS components (16 - 64 bytes), 15% asset names and small asset data (8 - 96 bytes)
+// 20% Hermes payload and worker arrays (128 - 1024 bytes), 18% growing Hermes buffers (realloc, doubling)
+// 2% large blocks, journal chunks and event tables (4 - 128 KB)
+enum class Operation{
+	Small,
+	Medium,
+	Grow,
+	Large,
+};
+
+static Operation pickOperation(uint32_t &state, size_t &size){
+	uint32_t r = nextRandom(state) % 100;
+
+	if (r < 45){
+		size = 16 + nextRandom(state) % 49;
+		return Operation::Small;
+	}
+	if (r < 60){
+		size = 8 + nextRandom(state) % 89;
+		return Operation::Small;
+	}
+	if (r < 80){
+		size = 128 + nextRandom(state) % 897;
+		return Operation::Medium;
+	}
+	if (r < 98){
+		size = 64;
+		return Operation::Grow;
+	}
+	size = 4096 + nextRandom(state) % (124 * 1024);
+	return Operation::Large;
+}
+
+struct Slot{
+	void* ptr = nullptr;
+	size_t size = 0;
+	bool growing = false;
+};
+
+// each operation allocates a free slot, grows a growing buffer or frees a slot
+static void runMix(const Allocator &allocator, uint32_t seed){
+	Slot* slots = new Slot[SLOT_COUNT];
+	uint32_t state = seed;
+
+	for (uint32_t i=0; i<OPERATION_COUNT; i++){
+		Slot &slot = slots[nextRandom(state) % SLOT_COUNT];
+
+		if (!slot.ptr){
+			Operation operation = pickOperation(state, slot.size);
+			slot.ptr = allocator.malloc(slot.size);
+			slot.growing = operation == Operation::Grow;
+			memset(slot.ptr, 0, slot.size < 64 ? slot.size : 64);
+		} else if (slot.growing && slot.size < 4096 && nextRandom(state) % 2 == 0){
+			slot.size *= 2;
+			slot.ptr = allocator.realloc(slot.ptr, slot.size);
+		} else {
+			allocator.free(slot.ptr);
+			slot.ptr = nullptr;
+		}
+	}
+
+	for (uint32_t i=0; i<SLOT_COUNT; i++){
+		allocator.free(slots[i].ptr);
+	}
+	delete[] slots;
+}
+
+struct ThreadData{
+	const Allocator* allocator;
+	uint32_t seed;
+};
+
+static void* mixThread(void* data){
+	ThreadData* thread = static_cast<ThreadData*>(data);
+	runMix(*thread->allocator, thread->seed);
+	return nullptr;
+}
+
+static double runThreads(const Allocator &allocator, uint32_t threadCount){
+	pthread_t threads[THREAD_COUNT];
+	ThreadData data[THREAD_COUNT];
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i=0; i<threadCount; i++){
+		data[i] = {&allocator, 0x9E3779B9u + i * 7919u};
+		pthread_create(&threads[i], nullptr, &mixThread, &data[i]);
+	}
+	for (uint32_t i=0; i<threadCount; i++){
+		pthread_join(threads[i], nullptr);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double operations = static_cast<double>(OPERATION_COUNT) * threadCount;
+	return std::chrono::duration<double, std::nano>(end - start).count() / operations;
+}
+
+int main(){
+	printf("%-12s %14s %14s\n", "allocator", "1 thread", "4 threads");
+
+	for (const Allocator &allocator : allocators){
+		// warm up, so both allocators start with their pools filled
+		runThreads(allocator, 1);
+
+		double single = runThreads(allocator, 1);
+		double multi = runThreads(allocator, THREAD_COUNT);
+		printf("%-12s %11.1f ns %11.1f ns\n", allocator.name, single, multi);
+	}
+
+	return 0;
+}
@@ -12,6 +12,9 @@
 #include <array>
 #include <queue>
 #include <set>
+#include <memory_resource>
+#include "horreum/PoolAllocator.hpp"
+#include "horreum/MemoryResource.hpp"
 
 namespace ECS{
     /**
@@ -32,7 +35,7 @@ namespace ECS{
 
     class ComponentArray{
         public:
-			ComponentArray(size_t componentSize) : componentSize{componentSize}{}
+			ComponentArray(size_t componentSize, std::pmr::memory_resource* resource) : _entityToIndexMap{resource}, _indexToEntityMap{resource}, componentSize{componentSize}, _componentPool(componentSize, 64){}
 			ComponentArray() = delete;
 
             void InsertData(Entity entity, void* component){
@@ -42,7 +45,7 @@ namespace ECS{
                 size_t newIndex = _size;
                 _entityToIndexMap[entity] = newIndex;
                 _indexToEntityMap[newIndex] = entity;
-                _componentArray[newIndex] = malloc(componentSize);
+                _componentArray[newIndex] = _componentPool.getElement();
 				if (component) memcpy(_componentArray[newIndex], component, componentSize);
                 ++_size;
             }
@@ -53,7 +56,7 @@ namespace ECS{
                 // Copy element at end into deleted element's place to maintain density
                 size_t indexOfRemovedEntity = _entityToIndexMap[entity];
                 size_t indexOfLastElement = _size - 1;
-				free(_componentArray[indexOfRemovedEntity]);
+				_componentPool.restoreElement(_componentArray[indexOfRemovedEntity]);
                 _componentArray[indexOfRemovedEntity] = _componentArray[indexOfLastElement];
 
                 // Update map to point to moved spot
@@ -95,13 +98,13 @@ namespace ECS{
             /**
              * @brief map entity id to array index
              */
-            std::unordered_map<Entity, std::size_t> _entityToIndexMap = {};
+            std::pmr::unordered_map<Entity, std::size_t> _entityToIndexMap;
 
             /**
              * @brief map array index to entity id
              * the invers of the _entotyToIndexMap
              */
-            std::unordered_map<std::size_t, Entity> _indexToEntityMap = {};
+            std::pmr::unordered_map<std::size_t, Entity> _indexToEntityMap;
 
             /**
              * @brief total size of entries in the array
@@ -109,10 +112,17 @@ namespace ECS{
             std::size_t _size = 0;
 
 			size_t componentSize = 0;
+
+            /**
+             * @brief the storage of the components, the elements are recycled when components are removed
+             */
+            PoolAllocator _componentPool;
     };
 
     class ComponentManager{
         public:
+            ComponentManager(std::pmr::memory_resource* resource) : _ComponentTypes{resource}, _componentArrays{resource}, _resource{resource}{}
+
             void RegisterComponent(size_t typeID, size_t componentSize){
                 assert(_ComponentTypes.find(typeID) == _ComponentTypes.end() && "Registering component type more than once.");
 
@@ -120,7 +130,8 @@ namespace ECS{
                 _ComponentTypes.insert({typeID, _NextComponentType});
 
                 // Create a ComponentArray pointer and add it to the component arrays map
-                _componentArrays.insert({typeID, std::make_shared<ComponentArray>(componentSize)});
+                Horreum::CategoryScope category(Horreum::Category::ECS);
+                _componentArrays.insert({typeID, std::allocate_shared<ComponentArray>(std::pmr::polymorphic_allocator<ComponentArray>(_resource), componentSize, _resource)});
 
                 // Increment the value so that the next component registered will be different
                 _NextComponentType++;
@@ -164,10 +175,12 @@ namespace ECS{
 
         private:
             // Map from type hash code to a component type
-            std::unordered_map<size_t, ComponentType> _ComponentTypes{};
+            std::pmr::unordered_map<size_t, ComponentType> _ComponentTypes;
 
             // Map from type hash code to a component array
-            std::unordered_map<size_t, std::shared_ptr<ComponentArray>> _componentArrays{};
+            std::pmr::unordered_map<size_t, std::shared_ptr<ComponentArray>> _componentArrays;
+
+            std::pmr::memory_resource* _resource;
 
             // The component type to be assigned to the next registered component - starting at 0
             ComponentType _NextComponentType{};
@@ -181,7 +194,7 @@ namespace ECS{
 
     class EntityManager{
         public:
-            EntityManager(){
+            EntityManager(std::pmr::memory_resource* resource) : _availablesEntities{std::pmr::deque<Entity>(resource)}{
                 // fill the available entity queue with ids
                 for (Entity entity = 0; entity<MAX_ENTITIES; entity++)
                     _availablesEntities.push(entity);
@@ -244,7 +257,7 @@ namespace ECS{
             /**
              * @brief the queue of available entities id to avoid holes in the entities array
              */
-            std::queue<Entity> _availablesEntities{};
+            std::queue<Entity, std::pmr::deque<Entity>> _availablesEntities;
 
             /**
              * @brief the array who store the entities signature
@@ -265,6 +278,8 @@ namespace ECS{
 
     class SystemManager{
         public:
+			SystemManager(std::pmr::memory_resource* resource) : mSignatures{resource}, mSystems{resource}{}
+
 			~SystemManager(){
 				for (auto &s : mSystems){
 					delete s.second;
@@ -320,10 +335,10 @@ namespace ECS{
 
         private:
             // Map from system type string pointer to a signature
-            std::unordered_map<size_t, Signature> mSignatures{};
+            std::pmr::unordered_map<size_t, Signature> mSignatures;
 
             // Map from system type string pointer to a system pointer
-            std::unordered_map<size_t, System*> mSystems{};
+            std::pmr::unordered_map<size_t, System*> mSystems;
     };
 
     class Coordinator{
@@ -332,9 +347,9 @@ namespace ECS{
 
             void Init(){
                 // Create pointers to each manager
-                _componentManager = std::make_unique<ComponentManager>();
-                _entityManager = std::make_unique<EntityManager>();
-                _systemManager = std::make_unique<SystemManager>();
+                _componentManager = std::make_unique<ComponentManager>(&_resource);
+                _entityManager = std::make_unique<EntityManager>(&_resource);
+                _systemManager = std::make_unique<SystemManager>(&_resource);
             }
 
             // Entity methods
@@ -397,6 +412,9 @@ namespace ECS{
             }
 
         private:
+            // the nodes and tables of the managers, declared first so it outlives them
+            PoolResource _resource{Horreum::Category::ECS};
+
             std::unique_ptr<ComponentManager> _componentManager;
             std::unique_ptr<EntityManager> _entityManager;
             std::unique_ptr<SystemManager> _systemManager;
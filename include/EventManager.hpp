@@ -5,5 +5,9 @@ namespace RainDrop{
 	void registerEvents();
 	void poolEvents();
 
+	// replay a Hermes journal and rebuild the input state from it
+	void startReplay(const char* path);
+	void stopReplay();
+
 	const char* KeyToStr(Key key);
 }
\ No newline at end of file
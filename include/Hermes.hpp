@@ -1,10 +1,16 @@
 #pragma once
 
 #include <iostream>
+#include <cstdio>
 #include <unordered_map>
 #include <list>
-#include "horreum/StackAllocator.hpp"
+#include <string>
+#include "horreum/FrameAllocator.hpp"
+#include "horreum/MemoryResource.hpp"
+#include "hermes/TimingWheel.hpp"
+#include "WorkerPool.hpp"
 #include <cassert>
+#include <pthread.h>
 
 
 #ifdef HERMES_ASSERTS
@@ -13,6 +19,9 @@
 	#define HERMES_ASSERT(x)
 #endif
 
+class JournalWriter;
+class JournalReader;
+
 class Hermes{
 	public:
 		using EventID = uint16_t;
@@ -26,6 +35,73 @@ class Hermes{
 			EventMt method;
 		};
 
+		// batch callbacks receive every payload of the event queued this frame, contiguous and in trigger order
+		using BatchFn = void(*)(void*, uint32_t); // batch function (the payloads and the payload count)
+		using BatchMt = void(*)(void*, void*, uint32_t); // batch method (the instance pointer, the payloads and the payload count)
+
+		union BatchCallback{
+			BatchFn function;
+			BatchMt method;
+		};
+
+		// how multiple triggers of the same event type are merged during a frame
+		enum class Coalescing{
+			KeepAll, // every trigger is queued and delivered
+			KeepLast, // the event occupies one slot per frame, only the last payload is delivered
+			Accumulate, // the event occupies one slot per frame, new payloads are merged into the queued one
+		};
+
+		// when the callbacks of an event type are called
+		enum class Delivery{
+			Deferred, // queued and dispatched by update on the calling thread, in trigger order
+			Immediate, // dispatched inline by the trigger, the payload is neither copied nor queued
+			Parallel, // queued and dispatched by update on the worker pool, one task per event type, concurrently with the deferred events
+		};
+
+		// merge the new payload (src) into the queued one (dst), size is the event data size
+		using AccumulateFn = void(*)(void* dst, const void* src, uint16_t size);
+
+		// handle of a delayed or repeating trigger, the index of the timer in the low bits and it generation in the high bits
+		using TimerID = uint64_t;
+		static constexpr TimerID INVALID_TIMER = 0;
+
+		// the time base of a timer
+		enum class Timeline{
+			Seconds, // ticked from the clock given to setClock, with a millisecond resolution
+			Frames, // ticked once per update
+		};
+
+		// the engine clock, in seconds
+		using ClockFn = double(*)();
+
+		// ! PROFILING, the counters are only updated when compiled with HERMES_PROFILE
+		static constexpr uint32_t LATENCY_BUCKET_COUNT = 16;
+
+		enum class StatsFormat{
+			CSV,
+			JSON, // one JSON object per frame and per line
+		};
+
+		struct EventStats{
+			const char* name = nullptr;
+			EventID id = 0;
+			uint32_t subscribers = 0; // callbacks and batch callbacks
+
+			// during the last frame
+			uint32_t triggers = 0;
+			uint32_t coalesced = 0; // triggers merged into an already queued slot
+			uint64_t payloadBytes = 0;
+			uint64_t callbackTime = 0; // in nanoseconds
+
+			uint64_t totalTriggers = 0;
+		};
+
+		struct CallbackStats{
+			uint64_t calls = 0;
+			uint64_t totalTime = 0; // in nanoseconds
+			uint32_t latency[LATENCY_BUCKET_COUNT] = {}; // latency[i] counts the calls that took less than 2^(i+8) ns, the last bucket counts the others
+		};
+
 		class DataLayout{
 			friend class Hermes;
 			public:
@@ -53,10 +129,25 @@ class Hermes{
 
 		~Hermes();
 
+		// bufferSize is the payload memory of one frame, the payloads of a frame stay valid until the end of the next update
 		static void initialize(uint16_t eventTypeCount, uint32_t bufferSize);
 
-		static EventID registerEvent(const char* name, uint16_t dataSize = 0);
-		static EventID registerEvent(const char* name, DataLayout data);
+		static EventID registerEvent(const char* name, uint16_t dataSize = 0, Coalescing coalescing = Coalescing::KeepAll, AccumulateFn accumulateFn = nullptr, Delivery delivery = Delivery::Deferred);
+		static EventID registerEvent(const char* name, DataLayout data, Coalescing coalescing = Coalescing::KeepAll, AccumulateFn accumulateFn = nullptr, Delivery delivery = Delivery::Deferred);
+		static EventID registerEvent(const char* name, uint16_t dataSize, Delivery delivery);
+
+		// the pool running the Delivery::Parallel events, without pool they are dispatched by update on the calling thread
+		static void setWorkerPool(WorkerPool* pool);
+
+		// accumulate function that sum the payload as an array of T (e.g. Hermes::accumulate<float> for a vec2<float> delta)
+		template<typename T>
+		static void accumulate(void* dst, const void* src, uint16_t size){
+			T* d = static_cast<T*>(dst);
+			const T* s = static_cast<const T*>(src);
+			for (uint16_t i=0; i<size / sizeof(T); i++){
+				d[i] += s[i];
+			}
+		}
 
 		static EventID getEventIndex(const char* name);
 
@@ -68,7 +159,23 @@ class Hermes{
 		template<typename T, typename... Args>
 		static void triggerEvent(EventID id, T t, Args... args){
 			Hermes& instance = getInstance();
-			void* data = _convert(instance.events[id].dataSize, t, args...);
+			HERMES_ASSERT(id < instance.registeredEventCount && "event type overflow");
+			EventType& event = instance.events[id];
+
+			size_t offset = 0;
+			size_t size = event.dataSize;
+
+			// immediate events are dispatched before returning, the payload can live on the stack
+			if (event.delivery == Delivery::Immediate){
+				char payload[(sizeof(T) + ... + sizeof(Args))];
+				HERMES_ASSERT(sizeof(payload) == size && "the arguments do not match the event data size");
+				__convert(payload, offset, size, t, args...);
+				_triggerEvent(id, payload);
+				return;
+			}
+
+			void* data = getPayloadSlot(event);
+			__convert(data, offset, size, t, args...);
 			_triggerEvent(id, data);
 		}
 
@@ -97,9 +204,51 @@ class Hermes{
 		static void unsubscribe(EventID id, EventFn callback);
 		static void unsubscribe(EventID id, EventMt callback);
 
-		// this function will call all callbacks of the triggered events and then reset the data buffer
+		static void subscribeBatch(const char *name, BatchFn callback);
+		static void subscribeBatch(const char *name, void* subscribedInstance, BatchMt callback);
+		static void subscribeBatch(EventID id, BatchFn callback);
+		static void subscribeBatch(EventID id, void* subscribedInstance, BatchMt callback);
+
+		static void unsubscribeBatch(const char *name, BatchFn callback);
+		static void unsubscribeBatch(const char *name, BatchMt callback);
+		static void unsubscribeBatch(EventID id, BatchFn callback);
+		static void unsubscribeBatch(EventID id, BatchMt callback);
+
+		// this function will expire the timers, call all callbacks of the triggered events and then reset the data buffer
 		static void update();
 
+		// set the clock used to advance the Timeline::Seconds timers
+		static void setClock(ClockFn clock);
+
+		// schedule a trigger of the event after the delay, then every interval if the interval is not null
+		// the payload of the event has to be written with getTimerPayload before the next update
+		static TimerID scheduleEvent(EventID id, Timeline timeline, double delay, double interval = 0.0);
+		static void* getTimerPayload(TimerID timer);
+
+		// cancel a pending timer, return false if the timer has already expired or been cancelled
+		static bool cancelTimer(TimerID timer);
+		static bool isTimerPending(TimerID timer);
+
+		template<typename... Args>
+		static TimerID triggerEventDelayed(EventID id, double seconds, Args... args){
+			return _scheduleEvent(id, Timeline::Seconds, seconds, 0.0, args...);
+		}
+
+		template<typename... Args>
+		static TimerID triggerEventAfterFrames(EventID id, uint32_t frames, Args... args){
+			return _scheduleEvent(id, Timeline::Frames, static_cast<double>(frames), 0.0, args...);
+		}
+
+		template<typename... Args>
+		static TimerID triggerEventRepeating(EventID id, double interval, Args... args){
+			return _scheduleEvent(id, Timeline::Seconds, interval, interval, args...);
+		}
+
+		template<typename... Args>
+		static TimerID triggerEventEveryFrames(EventID id, uint32_t frames, Args... args){
+			return _scheduleEvent(id, Timeline::Frames, static_cast<double>(frames), static_cast<double>(frames), args...);
+		}
+
 		static EventID getRegisteredEventCount();
 		static EventID getMaxEventTypeCount();
 		static size_t getMaxDataBufferSize();
@@ -109,8 +258,50 @@ class Hermes{
 		// ! DEBUG
 		static void printEvents();
 
+		// ! PROFILING
+		static EventStats getEventStats(EventID id);
+
+		// copy the stats of the callbacks of the event, in subscription order (callbacks then batch callbacks), return the callback count
+		static size_t getCallbackStats(EventID id, CallbackStats* stats, size_t maxCount);
+
+		// write the stats of the last frame and the latency histograms of the callbacks, only the triggered events are written
+		static void dumpStats(FILE* file, StatsFormat format);
+
+		// dump the stats of every frame into the file, a null path stop the dump
+		static void setStatsDump(const char* path, StatsFormat format = StatsFormat::CSV);
+
+		// record every trigger into a binary journal (see hermes/Journal.hpp), the file is written from a background thread
+		static void startRecording(const char* path);
+		static void stopRecording();
+		static bool isRecording();
+
+		// the triggers and event descriptions dropped because the journal writer could not keep up, a journal with drops does not replay the session
+		// the count of the running recording, or of the last one once stopped
+		static uint64_t getDroppedRecordCount();
+
+		// replay a journal, the external triggers it contains are queued again at the same frames
+		// isReplaying turns false at the end of the journal, stopReplay still has to be called to release it
+		static void startReplay(const char* path);
+		static void stopReplay();
+		static bool isReplaying();
+
+		// the triggers made between beginExternal and endExternal come from outside of the simulation (e.g. the SDL input)
+		// they are the ones injected back when a journal is replayed, the others are reproduced by the simulation itself
+		static void beginExternal();
+		static void endExternal();
+
+		// the number of updates since the initialization
+		static uint64_t getFrame();
+
 		static void* allocStack(size_t size){
-			return getInstance().dataBuffer->push(size);
+			return getInstance().dataBuffer->push(size, PAYLOAD_ALIGNMENT);
+		}
+
+		// allocate the payload of the next trigger of the event, coalesced events reuse their queued slot
+		static void* allocPayload(EventID id){
+			Hermes& instance = getInstance();
+			HERMES_ASSERT(id < instance.registeredEventCount && "event type overflow");
+			return getPayloadSlot(instance.events[id]);
 		}
 	
 		static void _triggerEvent(EventID eventID, void* data);
@@ -128,15 +319,31 @@ class Hermes{
 			Callback callback;
 			CallbackType type;
 			void* subscribedInstance = nullptr;
+
+			#ifdef HERMES_PROFILE
+				CallbackStats stats;
+			#endif
 		};
 
-		struct EventType{
-			#ifndef NDEBUG
-				char* name;
+		struct EventBatchCallback{
+			BatchCallback callback;
+			EventCallback::CallbackType type;
+			void* subscribedInstance = nullptr;
+
+			#ifdef HERMES_PROFILE
+				CallbackStats stats;
 			#endif
-			EventID id = 0;
-			uint16_t dataSize = 0;
-			std::list<EventCallback>* callbacks = nullptr;
+		};
+
+		struct Timer{
+			EventID event = 0;
+			Timeline timeline = Timeline::Seconds;
+			uint32_t generation = 1;
+			bool pending = false;
+			TimingWheel::Tick interval = 0;
+			void* payload = nullptr;
+			uint16_t payloadCapacity = 0;
+			uint32_t nextFree = TimingWheel::INVALID;
 		};
 
 		struct EventCall{
@@ -144,6 +351,35 @@ class Hermes{
 			void* data = nullptr;
 		};
 
+		struct EventType{
+			const char* name = nullptr; // owned by the event map
+			EventID id = 0;
+			uint16_t dataSize = 0;
+			std::pmr::list<EventCallback>* callbacks = nullptr;
+
+			Coalescing coalescing = Coalescing::KeepAll;
+			AccumulateFn accumulateFn = nullptr;
+			EventCall* pendingCall = nullptr; // the slot queued this frame for coalesced events
+
+			Delivery delivery = Delivery::Deferred;
+			void** parallelData = nullptr; // the payloads handed to the worker task
+			uint32_t parallelCount = 0;
+			uint32_t parallelCapacity = 0;
+
+			std::pmr::list<EventBatchCallback>* batchCallbacks = nullptr;
+			char* batchData = nullptr; // the payloads gathered for the batch callbacks
+			uint32_t batchCount = 0;
+			uint32_t batchCapacity = 0;
+			char* dispatchData = nullptr; // the payloads being dispatched, swapped with batchData, so the callbacks can trigger the event
+			uint32_t dispatchCount = 0;
+			uint32_t dispatchCapacity = 0;
+
+			#ifdef HERMES_PROFILE
+				EventStats frameStats; // the frame being recorded
+				EventStats lastFrameStats;
+			#endif
+		};
+
 		template<typename T, typename... Args>
 		static void convertFromVoid(void* ptr, size_t &offset, T &t, Args&... args){
 			void* data = static_cast<void*>(static_cast<char*>(ptr) + offset);
@@ -161,13 +397,8 @@ class Hermes{
 
 
 
-		template<typename... Args>
-		static void* _convert(size_t size, Args... args){
-			Hermes& instance = getInstance();
-			void* ptr = instance.dataBuffer->push(size);
-			size_t offset = 0;
-			return __convert(ptr, offset, size, args...);
-		}
+		// where the payload of the next trigger should be written, coalesced events reuse their queued slot
+		static void* getPayloadSlot(EventType& event);
 
 		template<typename T, typename... Args>
 		static void* __convert(void* data, size_t &offset, size_t &maxSize, T t, Args... args){
@@ -187,12 +418,91 @@ class Hermes{
 			return data;
 		}
 		
+		template<typename... Args>
+		static TimerID _scheduleEvent(EventID id, Timeline timeline, double delay, double interval, Args... args){
+			TimerID timer = scheduleEvent(id, timeline, delay, interval);
+			if constexpr (sizeof...(Args) > 0){
+				size_t offset = 0;
+				size_t size = getInstance().events[id].dataSize;
+				__convert(getTimerPayload(timer), offset, size, args...);
+			}
+			return timer;
+		}
+
+		static Timer* getTimer(TimerID timer);
+		static TimingWheel::Tick toTicks(Timeline timeline, double time);
+		static void expireTimer(uint32_t index);
+		static void releaseTimer(uint32_t index);
+		static void updateTimers();
+
+		#ifdef HERMES_PROFILE
+			static uint64_t profileNow();
+			static void profileCallback(CallbackStats &stats, EventStats &eventStats, uint64_t time);
+		#endif
+		static void endFrameStats();
+
+		static void recordEventType(EventID id, const char* name);
+		static void recordTrigger(EventID id, void* data);
+		static void recordFrame();
+		static void replayFrame();
+
+		// the queue is shared with the worker threads while parallel events are running
+		static void lockQueue();
+		static void unlockQueue();
+		static void launchParallel();
+		static void waitParallel();
+		static void runParallel(void* event);
+
 		static bool callCallback(EventCallback &callback, void* data);
+		static bool coalesce(EventType& event, void* data);
+		static void dispatchCallbacks(EventType& event, void* data);
+		static void dispatch(EventCall &call);
+		static void gatherBatch(EventType& event, void* data);
+		static void dispatchBatches();
 
 		EventType* events;
-		StackAllocator *dataBuffer;
-		std::list<EventCall> calls;
-		std::unordered_map<std::string, EventID> eventMap;
+		static constexpr size_t PAYLOAD_ALIGNMENT = 8;
+		static constexpr uint32_t PAYLOAD_FRAME_COUNT = 2;
+
+		// the nodes of the containers below, declared first so it outlives them
+		PoolResource resource{Horreum::Category::Events};
+
+		FrameAllocator *dataBuffer;
+		std::pmr::list<EventCall> calls{&resource};
+		void* coalesceBuffer = nullptr; // scratch payload for accumulated events, sized to the largest event
+		uint16_t coalesceBufferSize = 0;
+		EventID* batchQueue = nullptr; // the events with gathered payloads, in first trigger order
+		EventID batchQueueSize = 0;
+		EventID* dispatchQueue = nullptr; // the batch queue being dispatched, swapped with batchQueue
+
+		WorkerPool* workers = nullptr;
+		WorkerPool::Group parallelGroup;
+		std::pmr::list<EventCall> parallelCalls{&resource}; // the parallel events waiting for the next launch
+		std::pmr::list<EventCall> workerCalls{&resource}; // the triggers made from the parallel callbacks
+		EventID* parallelQueue = nullptr; // the event types being run by the workers
+		EventID parallelQueueSize = 0;
+		bool parallelInFlight = false;
+		pthread_mutex_t queueMutex;
+
+		ClockFn clock = nullptr;
+		uint64_t frame = 0;
+		TimingWheel secondsWheel;
+		TimingWheel framesWheel;
+		Timer* timers = nullptr;
+		uint32_t timerCount = 0;
+		uint32_t freeTimer = TimingWheel::INVALID;
+
+		JournalWriter* journal = nullptr;
+		uint64_t droppedRecords = 0; // of the last recording
+		JournalReader* replay = nullptr;
+		bool replayEnded = false;
+		EventID* replayMap = nullptr; // journal event id to registered event id
+		uint16_t replayMapSize = 0;
+		bool external = false;
+
+		FILE* statsDump = nullptr;
+		StatsFormat statsDumpFormat = StatsFormat::CSV;
+		std::pmr::unordered_map<std::pmr::string, EventID> eventMap{&resource};
 		EventID registeredEventCount = 0;
 		EventID maxAvailableEventTypeCount = 0;
 };
\ No newline at end of file
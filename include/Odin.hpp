@@ -1,40 +1,142 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <typeinfo>
 #include <unordered_map>
 #include <cassert>
+#include <cstring>
+#include <cstddef>
 #include <pthread.h>
-
-#ifndef NDEBUG
-	#include <cstring>
-#endif
+#include "WorkerPool.hpp"
+#include "horreum/MemoryResource.hpp"
+#include "odin/Pack.hpp"
+#include "odin/FileWatcher.hpp"
 
 class Odin{
-	private:	
-		struct AssetData{
-			void* assetPtr = nullptr;
-			uint16_t refCount = 0;
-			size_t hashCode = 0;
+	public:
+		// the loading state of an asset, Unloaded for the names without asset
+		enum class AssetState{
+			Unloaded,
+			Pending,
+			Loaded,
+			Failed,
+		};
 
-			#ifndef NDEBUG
-				char* assetType = nullptr;
-				char* name = nullptr;
-			#endif
+		// the order the queued asynchronous loads start in, the most urgent first
+		enum class Priority : uint8_t{
+			Critical, // not held back by the frame budget, the blocking loads and their dependencies
+			Visible,
+			Prefetch,
+			Background,
 		};
 
+		static constexpr uint32_t PRIORITY_COUNT = 4;
+
+		// the 64 bits FNV-1a hash of an asset name, the registry never stores nor compares the names
+		using AssetID = uint64_t;
+
+		// a slot of the asset table and its generation, 0 is never a valid handle
+		// a handle does not keep the asset alive, it can be stored anywhere (ECS components included) and resolves to nullptr once the asset is released
+		using Handle = uint32_t;
+		static constexpr Handle INVALID_HANDLE = 0;
+
+		// called on the main thread, by update, when an asynchronous load ends
+		// name is nullptr for the assets requested by id
+		using LoadCallback = void(*)(const char* name, void* asset, bool loaded, void* userData);
+
+		// the payload of an asset in a mounted pack, mapped in memory, valid until shutdown
+		struct Span{
+			const void* data;
+			size_t size;
+			uint64_t type; // hashName of the file extension
+		};
+
+		static constexpr AssetID hashName(const char* name){
+			AssetID hash = 0xcbf29ce484222325ULL;
+			while (*name){
+				hash ^= static_cast<uint8_t>(*name++);
+				hash *= 0x100000001b3ULL;
+			}
+			return hash;
+		}
+
 	public:
+		class Data;
+
+	private:
+		static constexpr uint32_t INDEX_BITS = 20;
+		static constexpr uint32_t INDEX_MASK = (1 << INDEX_BITS) - 1;
+		static constexpr uint32_t GENERATION_MASK = (1 << (32 - INDEX_BITS)) - 1;
+
+		// the table is allocated by pages that never move, so the slots are read without lock
+		static constexpr uint32_t PAGE_SHIFT = 10;
+		static constexpr uint32_t PAGE_SIZE = 1 << PAGE_SHIFT;
+		static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+		static constexpr uint32_t MAX_PAGE_COUNT = (INDEX_MASK + 1) / PAGE_SIZE;
+
+		static constexpr uint32_t NO_SLOT = ~0U;
+
+		struct LoadRequest;
+
+		struct Slot{
+			std::atomic<uint32_t> refCount{0}; // only taken from zero to one under the shard lock
+			std::atomic<uint32_t> generation{1}; // incremented when the slot is freed, never 0
+			std::atomic<void*> assetPtr{nullptr};
+			std::atomic<AssetState> state{AssetState::Unloaded};
+			AssetID id = 0;
+			size_t hashCode = 0;
+			char* name = nullptr; // a copy, nullptr for the assets requested by id
+			uint32_t shard = 0;
+			uint32_t nextFree = NO_SLOT;
+			Data* data = nullptr; // a copy of the load data, for the hot reload, guarded by the lock
+			std::vector<Handle>* dependencies = nullptr; // counted, released after the asset is destroyed, guarded by the lock
+			LoadRequest* load = nullptr; // the load not started yet, reprioritized or cancelled through the slot, guarded by the lock
+
+			// the cache of the unreferenced assets, guarded by the lock
+			size_t size = 0; // reported by the factory, 0 if the asset is not cached
+			uint32_t lruPrev = NO_SLOT;
+			uint32_t lruNext = NO_SLOT;
+			bool cached = false;
+		};
+
+	public:
+		// the packed arguments of a load, stored inline up to INLINE_CAPACITY bytes, so the lookups of the loaded assets never allocate
 		class Data{
 			public:
+				static constexpr size_t INLINE_CAPACITY = 64;
+
 				Data(){}
 				~Data(){
-					if (data) free(data);
+					reset();
 				}
 
 				Data(const Data &data){
-					this->data = malloc(data.size);
-					assert(this->data && "MALLOC ERROR");
-					memcpy(this->data, data.data, data.size);
-					size = data.size;
+					copy(data);
+				}
+
+				// a non const data would be taken by the variadic constructor as an argument
+				Data(Data &data) : Data(static_cast<const Data&>(data)){}
+
+				Data(Data &&data) noexcept{
+					move(data);
+				}
+
+				Data& operator=(const Data &data){
+					if (this == &data) return *this;
+					reset();
+					copy(data);
+					return *this;
+				}
+
+				Data& operator=(Data &&data) noexcept{
+					if (this == &data) return *this;
+					reset();
+					move(data);
+					return *this;
 				}
 
 				template<typename... Args>
@@ -53,12 +155,12 @@ class Odin{
 				void set(Args&&... args){
 					reset();
 					size = getArgsSize<Args...>();
-					data = malloc(size);
+					data = allocate(size);
 					setData(size, args...);
 				}
 
 				void reset(){
-					if (data) free(data);
+					if (data && data != buffer) free(data);
 					data = nullptr;
 					size = 0;
 				}
@@ -68,6 +170,35 @@ class Odin{
 				}
 			
 			private:
+				void* allocate(size_t size){
+					if (size <= INLINE_CAPACITY) return buffer;
+
+					void* ptr = malloc(size);
+					assert(ptr && "MALLOC ERROR");
+					return ptr;
+				}
+
+				void copy(const Data &data){
+					if (!data.size) return;
+					this->data = allocate(data.size);
+					memcpy(this->data, data.data, data.size);
+					size = data.size;
+				}
+
+				// the inline arguments are copied, the allocated ones are taken
+				void move(Data &data){
+					if (data.data == data.buffer){
+						copy(data);
+						data.reset();
+						return;
+					}
+
+					this->data = data.data;
+					size = data.size;
+					data.data = nullptr;
+					data.size = 0;
+				}
+
 				template<typename... Args>
 				void* setData(size_t size, Args... args){
 					void* ptr = data;
@@ -127,10 +258,36 @@ class Odin{
 				}
 
 				size_t size = 0;
-				void* data = nullptr;
+				void* data = nullptr; // the buffer, or allocated above INLINE_CAPACITY
+				alignas(std::max_align_t) char buffer[INLINE_CAPACITY];
 				
 		};
 
+		// the assets an asset needs, loaded before it on the loader threads and held until it is destroyed
+		// the factory of the asset gets them with getAsset, the dependencies must not form a cycle
+		class Dependencies{
+			friend class Odin;
+
+			public:
+				template<typename T, typename... Args>
+				void add(const char* name, Args&&... args){
+					add(name, typeid(T).hash_code(), Data(args...));
+				}
+
+				void add(const char* name, size_t typeID, const Data &data){
+					list.push_back({name, typeID, data});
+				}
+
+			private:
+				struct Dependency{
+					std::string name;
+					size_t typeID;
+					Data data;
+				};
+
+				std::vector<Dependency> list;
+		};
+
 		class Factory{
 			public:
 				Factory() = default;
@@ -139,75 +296,91 @@ class Odin{
 				virtual size_t getTypeHash() const = 0;
 				virtual void* create(const Data &data) = 0;
 				virtual void destroy(void* asset) = 0;
+
+				// called instead of create when a mounted pack contains the asset, the span can be used without copy
+				virtual void* createFromPack(const Span &span, const Data &data){return create(data);}
+
+				// the memory used by an asset, counted in the cache budget, the assets of size 0 are never cached
+				virtual size_t getSize(void* asset){return 0;}
+
+				// add the assets needed by the asset to create, called before create, without loading anything
+				virtual void getDependencies(const Data &data, Dependencies &dependencies){}
 		};
 
+		// a counted reference to an asset, the asset itself may still be loading
 		template<typename T>
 		class Reference{
 			friend class Odin;
 
-			using IT = std::unordered_map<std::string, AssetData>::iterator;
 			public:
 				Reference(){}
 				Reference(const Reference<T> &other){
-					set(other.it);
-				}
-
-				Reference(const IT &it){
-					set(it);
+					set(other);
 				}
 
 				~Reference(){reset();}
-				void reset() {if (*this){removeRef();}}
+				void reset(){
+					if (handle) release(getSlot(handle));
+					handle = INVALID_HANDLE;
+				}
 
-				uint16_t refCount() const {if (*this){return it->second.refCount;} return 0;}
+				uint32_t refCount() const {if (*this){return getSlot(handle).refCount.load(std::memory_order_relaxed);} return 0;}
 
 				void operator=(const Reference<T>& other){
-					set(other.it);
+					if (this == &other) return;
+					reset();
+					set(other);
 				}
 
-				T* operator->() const {return &it->second;}
-				T& operator*() {return *static_cast<T*>(it->second.assetPtr);}
-				operator bool() const {return it != getInstance().nameToAssetMap.end();}
-				bool operator==(const Reference<T> &other) {return it == other.it;}
-				bool operator!=(const Reference<T> &other) {return it != other.it;}
-				
-				void set(IT it){
-					this->it = it;
-					it->second.refCount++;
-				}
+				T* operator->() const {return static_cast<T*>(getSlot(handle).assetPtr.load(std::memory_order_acquire));}
+				T& operator*() {return *operator->();}
+				operator bool() const {return handle != INVALID_HANDLE;}
+				bool operator==(const Reference<T> &other) {return handle == other.handle;}
+				bool operator!=(const Reference<T> &other) {return !(*this == other);}
 
-				void removeRef(){
-					if (!*this) return;
+				AssetState getState() const {return handle ? getSlot(handle).state.load(std::memory_order_acquire) : AssetState::Unloaded;}
+				bool isLoaded() const {return getState() == AssetState::Loaded;}
 
-					auto& ref = it->second.refCount;
-					ref--;
-					if (ref == 0){
-						removeAsset(it);
-					}
+				// the uncounted handle, valid as long as a reference to the asset exists
+				Handle getHandle() const {return handle;}
+
+			private:
+				// take over a reference already counted
+				Reference(Handle handle) : handle{handle}{}
+
+				void set(const Reference<T> &other){
+					handle = other.handle;
+					if (handle) retain(getSlot(handle));
 				}
 
-				IT it;
+				Handle handle = INVALID_HANDLE;
 		};
 
 		Odin();
 		~Odin();
 
-		static void initialize();
+		// loaderThreadCount threads run the asynchronous loads and the dependencies, 0 for one per hardware thread minus the calling one
+		static void initialize(uint32_t loaderThreadCount = 0);
+
+		// wait for the loads in flight, destroy every asset, stop the loader threads and unmount the packs
+		static void shutdown();
+
+		// map a pack built by tools/OdinPacker.cpp, the assets it contains are created from it
+		// the packs mounted last are searched first
+		static void mountPack(const char* path);
 
 		template<typename T, typename... Args>
 		static void registerFactory(Args... args){
-			Odin& instance = getInstance();
 			T* factory = new T();
 			factory->init(args...);
-			instance.typeToFactoryMap[factory->getTypeHash()] = factory;
+			registerFactoryPtr(factory);
 		}
 
-		static void registerFactoryPtr(Factory* factory){
-			getInstance().typeToFactoryMap[factory->getTypeHash()] = factory;
-		}
+		static void registerFactoryPtr(Factory* factory);
 
 		/**
 		 * @brief return a reference to the requested asset, load the asset if it was not loaded before
+		 * if an asynchronous load of the asset is in flight, wait for it
 		 * 
 		 * @tparam T 
 		 * @param filepath the path to the asset to load, an absloute path or a path relative to the .data folder
@@ -215,151 +388,263 @@ class Odin{
 		 */
 		template<typename T, typename... Args>
 		static Reference<T> getAsset(const char* name, Args&&... args){
-			Odin& instance = getInstance();
-			// check if the asset as already been loaded
+			Data data(args...);
+			return Reference<T>(acquire(hashName(name), name, typeid(T).hash_code(), data));
+		}
 
-			pthread_mutex_lock(&instance.lock);
-			auto it = instance.nameToAssetMap.find(name);
-			bool assetDontExist = it == instance.nameToAssetMap.end();
+		// same as above, with the name hashed once by the caller, hashName is constexpr
+		template<typename T, typename... Args>
+		static Reference<T> getAsset(AssetID id, Args&&... args){
+			Data data(args...);
+			return Reference<T>(acquire(id, nullptr, typeid(T).hash_code(), data));
+		}
 
-			if (assetDontExist){
-				auto ref = loadAsset<T, Args...>(name, args...);
-				pthread_mutex_unlock(&instance.lock);
-				return ref;
-			}
+		/**
+		 * @brief return a reference to the requested asset immediately, the asset is loaded by a loader thread if it was not loaded before
+		 * the reference is pending until the load ends, the callback is called by update on the main thread
+		 * 
+		 * @tparam T 
+		 * @param callback called when the asset is loaded or failed to load, nullptr to poll the reference instead
+		 * @param userData given to the callback
+		 * @return Reference<T> 
+		 */
+		template<typename T, typename... Args>
+		static Reference<T> getAssetAsync(const char* name, LoadCallback callback, void* userData, Args&&... args){
+			Data data(args...);
+			return Reference<T>(acquireAsync(hashName(name), name, typeid(T).hash_code(), data, callback, userData, Priority::Visible));
+		}
 
-			Reference<T> ref(it);
-			
-			pthread_mutex_unlock(&instance.lock);
-			return ref;
+		template<typename T, typename... Args>
+		static Reference<T> getAssetAsync(AssetID id, LoadCallback callback, void* userData, Args&&... args){
+			Data data(args...);
+			return Reference<T>(acquireAsync(id, nullptr, typeid(T).hash_code(), data, callback, userData, Priority::Visible));
 		}
 
-		static void* getAssetPtr(const char* name, size_t typeID, Data &data, uint16_t*& count, void(**removeAsset)(const char*)){
-			Odin& instance = getInstance();
-	
-			pthread_mutex_lock(&instance.lock);
-			auto it = instance.nameToAssetMap.find(name);
-			bool assetDontExist = it == instance.nameToAssetMap.end();
-
-			if (assetDontExist){
-				it = loadAssetPtr(name, data, typeID);
-				count = &it->second.refCount;
-				*removeAsset = &Odin::removeAssetFromName;
-				pthread_mutex_unlock(&instance.lock);
-				return it->second.assetPtr;
-			}
+		// same as above, the queued loads start by priority, the loads already queued at a lower one are raised
+		template<typename T, typename... Args>
+		static Reference<T> getAssetAsync(const char* name, Priority priority, LoadCallback callback, void* userData, Args&&... args){
+			Data data(args...);
+			return Reference<T>(acquireAsync(hashName(name), name, typeid(T).hash_code(), data, callback, userData, priority));
+		}
+
+		template<typename T, typename... Args>
+		static Reference<T> getAssetAsync(AssetID id, Priority priority, LoadCallback callback, void* userData, Args&&... args){
+			Data data(args...);
+			return Reference<T>(acquireAsync(id, nullptr, typeid(T).hash_code(), data, callback, userData, priority));
+		}
 
-			it->second.refCount++;
-			pthread_mutex_unlock(&instance.lock);
-			return it->second.assetPtr;
+		// the asset of a handle, nullptr if the asset was released or is not loaded
+		// an index and a generation check, the pointer stays valid until the next update
+		template<typename T>
+		static T* get(Handle handle){
+			return static_cast<T*>(getAssetPtr(handle));
 		}
-		
+
+		static void* getAssetPtr(Handle handle);
+
+		// the counted handles of the engine api, the holder of a handle from acquireHandle must call releaseHandle once
+		static Handle acquireHandle(const char* name, size_t typeID, const Data &data);
+		static void retainHandle(Handle handle);
+		static void releaseHandle(Handle handle);
+
+		// load the asset in the background if it was not loaded before, return at once a counted handle to the pending asset
+		static Handle acquireHandleAsync(const char* name, size_t typeID, const Data &data, LoadCallback callback, void* userData, Priority priority = Priority::Visible);
+
+		// move a load not started yet to an other priority, raising it raises its dependencies too
+		// false if the asset is not waiting to load
+		static bool setLoadPriority(const char* name, Priority priority);
+		static bool setLoadPriority(AssetID id, Priority priority);
+
+		// end a load not started yet as failed, the callbacks are called with loaded false and the assets depending on it fail
+		// the next request of the asset loads it again, false if the load already started
+		static bool cancelLoad(const char* name);
+		static bool cancelLoad(AssetID id);
+
+		// cap the work of the loads in each frame, 0 for no cap, the critical loads are never held back
+		// the loader threads start no more load once the sizes of the assets loaded since the last update, reported by the factories, reach bytes
+		// update stops calling the load callbacks after microseconds, the remaining ones are called by the next updates
+		static void setFrameBudget(size_t bytes, uint32_t microseconds);
+
+		static AssetState getAssetState(const char* name);
+		static AssetState getAssetState(AssetID id);
+
+		// replace the asset with a new one, the references and the handles keep pointing to it
 		template<typename T, typename... Args>
 		static void reload(const char* name, Args&&... args){
-			Odin& instance = getInstance();
+			Data data(args...);
+			reloadPtr(hashName(name), name, typeid(T).hash_code(), data);
+		}
 
-			pthread_mutex_lock(&instance.lock);
-			auto it = instance.nameToAssetMap.find(name);
+		static void reloadPtr(AssetID id, const char* name, size_t typeID, const Data &data);
 
-			removeAsset(it);
-			loadAsset<T, Args...>(name, args...);
-			pthread_mutex_unlock(&instance.lock);
-		}
+		/**
+		 * @brief reload the assets when their file changes, the files are watched by a background thread, only supported on linux
+		 * the asset names must be the paths of the files from root, as given, ex: watch(".data") for ".data/images/ship.png"
+		 * the new assets are created on the loader threads, with the data of the first load, and replace the previous ones in update
+		 * 
+		 * @param debounceMilliseconds the time without changes to wait before reloading a file
+		 */
+		static void watch(const char* root, uint32_t debounceMilliseconds = 200);
+		static void unwatch();
+
+		// call the callbacks of the ended asynchronous loads, destroy the released assets and swap the hot reloaded ones, on the main thread
+		static void update();
+
+		// the assets without reference are kept until their total size, reported by the factories, goes over the budget
+		// then the least recently released ones are destroyed, 0 disables the cache
+		static void setCacheBudget(size_t bytes);
+		static size_t getCacheSize();
 
 		static void clear();
 		
 	private:
-		static Odin& getInstance();
+		// the id registry is split into shards, each with its own reader-writer lock
+		// the hits on loaded assets only take the read lock of their shard, so they run concurrently
+		static constexpr uint32_t SHARD_COUNT = 16;
 
-		template<typename T>
-		static Factory* getTypeFactory(){
-			return getTypeFactory(typeid(T).hash_code());
-		}
+		struct alignas(64) Shard{
+			Shard();
+			~Shard();
+
+			pthread_rwlock_t lock;
+			PoolResource resource{Horreum::Category::Assets};
+			std::pmr::unordered_map<AssetID, uint32_t> slots{&resource}; // id to slot index
+		};
 
-		static Factory* getTypeFactory(size_t hashCode){
-			Odin& instance = getInstance();
+		struct LoadRequest{
+			Handle handle; // the request holds a reference to the asset
+			Factory* factory;
+			Data data;
+			LoadCallback callback;
+			void* userData;
+			Priority priority; // guarded by the lock while the load is not started
+			bool queued = false; // waiting for a loader thread, guarded by the lock
+			bool cancelled = false; // guarded by the lock
+
+			// the dependencies still loading, plus one while they are requested, the load is scheduled by the one ending the count
+			std::atomic<uint32_t> pendingDependencies{0};
+			std::atomic<bool> dependencyFailed{false};
+		};
 
-			auto it = instance.typeToFactoryMap.find(hashCode);
-			assert(it != instance.typeToFactoryMap.end() && "factory not registred for this type of asset");
+		// a load waiting for a dependency
+		struct DependentLoad{
+			Handle dependency;
+			LoadRequest* request;
+		};
 
-			return it->second;
-		}
+		// an asset removed from the table, destroyed by update
+		struct DeadAsset{
+			void* asset;
+			size_t hashCode;
+			std::vector<Handle>* dependencies; // released once the asset is destroyed
+		};
 
-		// this function should be call when the asset is not loaded into the asset manager, if it is, it will be overwrite
-		template<typename T, typename... Args>
-		static Reference<T> loadAsset(const char *name, Args&... args){
-			Odin &instance = getInstance();
-			Factory* factory = getTypeFactory<T>();
+		// a hot reloaded asset, swapped in by update
+		struct Reload{
+			Handle handle; // the reload holds a reference to the slot
+			void* asset;
+			size_t size;
+		};
 
-			void* asset = factory->create(Data(args...));
-			assert(asset != nullptr && "cannot use a nullptr as an asset");
+		static Odin& getInstance();
 
-			AssetData data;
-			data.assetPtr = asset;
-			data.hashCode = typeid(T).hash_code();
-			data.refCount = 0;
-			
-			data.name = static_cast<char*>(malloc(sizeof(char) * strlen(name)));
-			strcpy(data.name, name);
+		static Factory* getTypeFactory(size_t hashCode);
 
-			auto it = instance.nameToAssetMap.find(name);
-			bool assetExist = it != instance.nameToAssetMap.end();
+		static Slot& getSlot(Handle handle);
+		static uint32_t getShardIndex(AssetID id){return static_cast<uint32_t>(id >> 32) % SHARD_COUNT;}
 
-			// if the asset name is already used, we delete the previous asset
-			if (assetExist){
-				removeAsset(it);
-			}
+		// the lock must be held
+		uint32_t allocateSlot();
+		void freeSlot(uint32_t index);
 
-			instance.nameToAssetMap.insert({name, data});
-			it = instance.nameToAssetMap.find(name);
+		// move the slot at the most recent end of the cache, or take it out, the lock must be held
+		void cache(uint32_t index);
+		void uncache(uint32_t index);
 
-			Reference<T> ref(it);
-			return ref;
-		}
+		// destroy the least recently released assets until the cache fits the budget
+		static void evict();
 
-		static std::unordered_map<std::string, Odin::AssetData>::iterator loadAssetPtr(const char *name, Data &data, size_t typeID){
-			Odin &instance = getInstance();
-			Factory* factory = getTypeFactory(typeID);
+		// find or create the asset and count a reference
+		static Handle findOrInsert(AssetID id, const char* name, size_t typeID, const Data &data, bool &inserted);
 
-			void* asset = factory->create(data);
-			assert(asset != nullptr && "cannot use a nullptr as an asset");
+		// count a reference to an asset already in the table, INVALID_HANDLE if there is none
+		static Handle retainExisting(AssetID id, const char* name);
 
-			AssetData d;
-			d.assetPtr = asset;
-			d.hashCode = typeID;
-			d.refCount = 0;
-			d.name = static_cast<char*>(malloc(sizeof(char) * strlen(name)));
-			strcpy(d.name, name);
+		// a failed or cancelled asset goes back to pending with the new data, true if the caller has to start its load
+		static bool restartFailed(Slot &slot, const Data &data);
 
-			auto it = instance.nameToAssetMap.find(name);
-			bool assetExist = it != instance.nameToAssetMap.end();
+		// called by the watcher thread, create the new asset on a loader thread
+		static void onFileChanged(const char* path, void* userData);
+		static void runReload(void* handle);
 
-			// if the asset name is already used, we delete the previous asset
-			if (assetExist){
-				removeAsset(it);
-			}
+		// publish the result of a load and wake the threads waiting for it
+		static void endLoad(Handle handle, void* ptr, size_t size);
+		static void waitLoad(Slot &slot);
 
-			instance.nameToAssetMap.insert({name, d});
-			it = instance.nameToAssetMap.find(name);
+		// run the factory outside of the lock, from the mounted packs if one of them has the asset, return nullptr on failure
+		// the packs are skipped by the hot reload, their payload is the one of the previous file
+		static void* create(Factory* factory, AssetID id, const Data &data, bool fromPacks = true);
 
-			return it;
-		}
+		// request the dependencies of a new asset, then schedule its load once they are loaded
+		static void startLoad(LoadRequest* request, Dependencies &dependencies);
+		static void scheduleLoad(LoadRequest* request);
 
-		static void removeAsset(std::unordered_map<std::string, AssetData>::iterator it);
+		// the loader tasks take the queued loads by priority until none is left or the frame budget is spent
+		static void runLoads(void*);
+		static void dispatchLoads();
+		size_t getQueuedLoadCount() const; // the lock must be held
+		LoadRequest* popLoad(); // the lock must be held, nullptr when nothing can start
 
-		static void removeAssetFromName(const char *name){
-			Odin& instance = getInstance();
-			auto it = instance.nameToAssetMap.find(name);
-			if (it == instance.nameToAssetMap.end()){
-				throw "cannot remove non existant asset";
-			}
+		static bool setPriority(Handle handle, Priority priority, bool raiseOnly);
+		static bool cancel(Handle handle);
+		static bool findInPacks(AssetID id, Span &span);
+		static void runLoad(void* request);
 
-			removeAsset(it);
-		}
+		static Handle acquire(AssetID id, const char* name, size_t typeID, const Data &data);
+		static Handle acquireAsync(AssetID id, const char* name, size_t typeID, const Data &data, LoadCallback callback, void* userData, Priority priority);
+		static void retain(Slot &slot);
+
+		// the count only takes the shard lock for the last reference, the asset is then queued for destruction
+		static void release(Slot &slot);
+
+		// the dependencies are released after the destruction, unless the table was cleared
+		static void destroy(const std::vector<DeadAsset> &dead, bool releaseDependencies = true);
 
-		static void deleteAssetData(AssetData &asset);
+		Shard shards[SHARD_COUNT];
 
+		// the factories, the loads and the slot allocation, never held across factory work
 		pthread_mutex_t lock;
+		pthread_cond_t loadCondition; // broadcast every time a load ends
 		std::unordered_map<size_t, Factory*> typeToFactoryMap;
-		std::unordered_map<std::string, AssetData> nameToAssetMap;
-};
\ No newline at end of file
+		std::vector<Pack*> packs; // guarded by the lock
+
+		std::atomic<Slot*> pages[MAX_PAGE_COUNT] = {};
+		uint32_t slotCount = 0; // guarded by the lock
+		uint32_t freeSlots = NO_SLOT; // the head of the free list, guarded by the lock
+
+		size_t cacheBudget = 0; // guarded by the lock
+		size_t cacheSize = 0; // guarded by the lock
+		uint32_t lruHead = NO_SLOT; // the least recently released, guarded by the lock
+		uint32_t lruTail = NO_SLOT; // guarded by the lock
+
+		WorkerPool* loaders = nullptr;
+		WorkerPool::Group loadGroup;
+		std::vector<LoadRequest*> waitingLoads; // the requests on an asset already loading, guarded by the lock
+		std::vector<LoadRequest*> completedLoads; // guarded by the lock
+		std::vector<DependentLoad> dependentLoads; // guarded by the lock
+
+		// the loads waiting for a loader thread, by priority, guarded by the lock
+		std::deque<LoadRequest*> queuedLoads[PRIORITY_COUNT];
+		uint32_t loadTasks = 0; // the tasks taking the queued loads, at most one per loader thread, guarded by the lock
+
+		// guarded by the lock
+		size_t frameByteBudget = 0;
+		uint32_t frameTimeBudget = 0; // microseconds
+		size_t frameBytes = 0; // loaded since the last update
+		std::vector<DeadAsset> deadAssets; // released by any thread, destroyed by update, guarded by the lock
+		std::vector<Reload> completedReloads; // guarded by the lock
+
+		FileWatcher* watcher = nullptr;
+		std::string watchRoot;
+		uint32_t watchDebounce = 0;
+};
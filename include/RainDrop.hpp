@@ -27,6 +27,8 @@
 
 #include <typeinfo>
 #include <stdint.h>
+#include <cstddef>
+#include <atomic>
 #include <assert.h>
 #include <set>
 #include <bitset>
@@ -61,6 +63,8 @@ namespace RainDrop{
 	using TextureID = uint64_t;
 	using SoundID = uint64_t;
 	using SoundSourceID = uint64_t;
+	using EventTimerID = uint64_t;
+	using AssetHandle = uint32_t; // an index and a generation, 0 is never a valid handle
 
 	class RD_API Exception{
 		public:
@@ -83,6 +87,52 @@ namespace RainDrop{
 	// =============== ENUMS
 
 	// === events
+	// how the triggers of an event are merged during a frame
+	enum class EventCoalescing{
+		KeepAll,
+		KeepLast,
+		Accumulate,
+	};
+
+	// when the callbacks of an event are called
+	enum class EventDelivery{
+		Deferred, // by updateEvents, on the calling thread
+		Immediate, // inline, by the trigger
+		Parallel, // by updateEvents, on the engine worker pool, concurrently with the deferred events
+	};
+
+	// format of the per frame event stats dump
+	enum class EventStatsFormat{
+		CSV,
+		JSON,
+	};
+
+	// the engine subsystem an allocation is accounted to
+	enum class MemoryCategory{
+		User,
+		ECS,
+		Events,
+		Assets,
+		Audio,
+		Render,
+	};
+
+	// the loading state of an asset
+	enum class AssetState{
+		Unloaded,
+		Pending,
+		Loaded,
+		Failed,
+	};
+
+	// the order the queued asset loads start in, the most urgent first
+	enum class AssetPriority : uint8_t{
+		Critical, // not held back by the frame budget
+		Visible,
+		Prefetch,
+		Background,
+	};
+
 	// mouse buttons
 	enum class MouseButton{
 		Left,
@@ -432,6 +482,38 @@ namespace RainDrop{
 		float r, g, b, a;
 	};
 
+	// event dispatch stats of the last frame, only filled when the engine is built with HERMES_PROFILE
+	struct EventStats{
+		const char* name;
+		EventID id;
+		uint32_t subscribers;
+		uint32_t triggers;
+		uint32_t coalesced;
+		uint64_t payloadBytes;
+		uint64_t callbackTime; // in nanoseconds
+		uint64_t totalTriggers;
+	};
+
+	static constexpr uint32_t EVENT_LATENCY_BUCKET_COUNT = 16;
+
+	// dispatch stats of an event callback, since its subscription
+	struct EventCallbackStats{
+		uint64_t calls;
+		uint64_t totalTime; // in nanoseconds
+		uint32_t latency[EVENT_LATENCY_BUCKET_COUNT]; // latency[i] counts the calls that took less than 2^(i+8) ns, the last bucket counts the others
+	};
+
+	// live memory counters of a category
+	struct MemoryStats{
+		uint64_t liveBytes;
+		uint64_t peakBytes;
+		uint64_t liveAllocations;
+		uint64_t frameAllocations; // the allocations made during the last frame
+		uint64_t totalAllocations;
+		uint64_t softBudget;
+		uint64_t hardBudget;
+	};
+
 	// math
 	template<typename T>
 	struct vec2{
@@ -451,11 +533,39 @@ namespace RainDrop{
 	// =============== CLASSES
 	class RD_API Entity;
 
+	// the packed arguments of an asset, stored inline up to INLINE_CAPACITY bytes, the same layout as the Odin ones
 	class RD_API AssetData{
 		public:
+			static constexpr size_t INLINE_CAPACITY = 64;
+
 			AssetData(){}
 			~AssetData(){
-				if (data) free(data);
+				reset();
+			}
+
+			AssetData(const AssetData &data){
+				copy(data);
+			}
+
+			// a non const data would be taken by the variadic constructor as an argument
+			AssetData(AssetData &data) : AssetData(static_cast<const AssetData&>(data)){}
+
+			AssetData(AssetData &&data) noexcept{
+				move(data);
+			}
+
+			AssetData& operator=(const AssetData &data){
+				if (this == &data) return *this;
+				reset();
+				copy(data);
+				return *this;
+			}
+
+			AssetData& operator=(AssetData &&data) noexcept{
+				if (this == &data) return *this;
+				reset();
+				move(data);
+				return *this;
 			}
 
 			template<typename... Args>
@@ -474,12 +584,12 @@ namespace RainDrop{
 			void set(Args&&... args){
 				reset();
 				size = getArgsSize<Args...>();
-				data = malloc(size);
+				data = allocate(size);
 				setData(size, args...);
 			}
 
 			void reset(){
-				if (data) free(data);
+				if (data && data != buffer) free(data);
 				data = nullptr;
 				size = 0;
 			}
@@ -489,6 +599,35 @@ namespace RainDrop{
 			}
 		
 		private:
+			void* allocate(size_t size){
+				if (size <= INLINE_CAPACITY) return buffer;
+
+				void* ptr = malloc(size);
+				assert(ptr && "MALLOC ERROR");
+				return ptr;
+			}
+
+			void copy(const AssetData &data){
+				if (!data.size) return;
+				this->data = allocate(data.size);
+				memcpy(this->data, data.data, data.size);
+				size = data.size;
+			}
+
+			// the inline arguments are copied, the allocated ones are taken
+			void move(AssetData &data){
+				if (data.data == data.buffer){
+					copy(data);
+					data.reset();
+					return;
+				}
+
+				this->data = data.data;
+				size = data.size;
+				data.data = nullptr;
+				data.size = 0;
+			}
+
 			template<typename... Args>
 			void* setData(size_t size, Args... args){
 				void* ptr = data;
@@ -548,10 +687,37 @@ namespace RainDrop{
 			}
 
 			size_t size = 0;
-			void* data = nullptr;
+			void* data = nullptr; // the buffer, or allocated above INLINE_CAPACITY
+			alignas(std::max_align_t) char buffer[INLINE_CAPACITY];
 			
 	};
 
+	// the payload of an asset in a mounted pack, mapped in memory until shutdown
+	struct AssetSpan{
+		const void* data;
+		size_t size;
+		uint64_t type; // the FNV-1a hash of the file extension
+	};
+
+	class RD_API AssetDependencies;
+
+	// defined with the asset functions, used by AssetDependencies
+	void RD_API addAssetDependency(AssetDependencies &dependencies, uint64_t typeID, const char* name, const AssetData &data);
+
+	// the assets an asset needs, loaded in parallel before it and held until it is destroyed
+	// only given to AssetFactory::getDependencies, the dependencies must not form a cycle
+	class RD_API AssetDependencies{
+		public:
+			AssetDependencies() = delete;
+			AssetDependencies(const AssetDependencies&) = delete;
+
+			// the name is copied before getDependencies returns
+			template<typename T, typename... Args>
+			void add(const char* name, Args&&... args){
+				addAssetDependency(*this, typeid(T).hash_code(), name, AssetData(args...));
+			}
+	};
+
 	class RD_API AssetFactory{
 		public:
 			AssetFactory() = default;
@@ -560,50 +726,69 @@ namespace RainDrop{
 			virtual size_t getTypeHash() const = 0;
 			virtual void* create(const AssetData &data) = 0;
 			virtual void destroy(void* asset) = 0;
+
+			// called instead of create when a mounted pack contains the asset, the span can be used without copy
+			virtual void* createFromPack(const AssetSpan &span, const AssetData &data){return create(data);}
+
+			// the memory used by an asset, counted in the asset cache budget, the assets of size 0 are never cached
+			virtual size_t getSize(void* asset){return 0;}
+
+			// add the assets needed by the asset to create, create is called once they are loaded and gets them with getAsset
+			virtual void getDependencies(const AssetData &data, AssetDependencies &dependencies){}
 	};
 
+	// defined with the asset functions, used by AssetReference
+	void RD_API retainAsset(AssetHandle handle);
+	void RD_API releaseAsset(AssetHandle handle);
+	void* RD_API getAssetPtr(AssetHandle handle);
+
+	/**
+	 * @brief called on the main thread, by updateEvents, when an asynchronous load ends
+	 */
+	using AssetLoadCallback = void(*)(const char* name, void* asset, bool loaded, void* userData);
+
+	// a counted reference to an asset, copied without lock from any thread
+	// the released assets are destroyed by updateEvents, on the main thread
 	template<typename T>
 	class RD_API AssetReference{
 		public:
 			AssetReference() = default;
 			AssetReference(const AssetReference<T>& other){set(other);}
-			void operator=(const AssetReference<T>& other){set(other);}
+			void operator=(const AssetReference<T>& other){
+				if (this == &other) return;
+				reset();
+				set(other);
+			}
 
 			~AssetReference(){reset();}
 
 			void reset(){
-				if (asset){
-					(*count)--;
-					if (*count == 0){
-						removeAsset(asset);
-					}
-				}
-				asset = nullptr;
-				count = nullptr;
-				removeAsset = nullptr;
+				if (handle) releaseAsset(handle);
+				handle = 0;
 			}
 
-			T* operator->() const {return asset;}
-			T& operator&() {return *asset;}
-			operator bool() const {return asset != nullptr;}
-			bool operator==(const AssetReference<T> &other) {return asset == other.asset;}
-			bool operator!=(const AssetReference<T> &other) {return asset != other.asset;}
+			T* operator->() const {return static_cast<T*>(getAssetPtr(handle));}
+			T& operator&() {return *operator->();}
+			operator bool() const {return handle != 0;}
+			bool operator==(const AssetReference<T> &other) {return handle == other.handle;}
+			bool operator!=(const AssetReference<T> &other) {return handle != other.handle;}
+
+			// the uncounted handle, can be stored in a component, getAssetPtr returns nullptr once the asset is released
+			AssetHandle getHandle() const {return handle;}
 
 		private:
 			void set(const AssetReference<T>& other){
-				count = other.count;
-				(*count)++;
-				asset = other.asset;
-				removeAsset = other.removeAsset;
+				handle = other.handle;
+				if (handle) retainAsset(handle);
 			}
 
-			// callback when the count get down to zero
-			void (*removeAsset)(void*) = nullptr;
-			uint16_t* count = nullptr;
-			T* asset = nullptr;
+			AssetHandle handle = 0;
+
+			template<typename G, typename... Args>
+			friend AssetReference<G> getAsset(const char* name, Args&... args);
 
 			template<typename G, typename... Args>
-			friend AssetReference<G> createAsset(const char* name, Args&... args);
+			friend AssetReference<G> getAssetAsync(const char* name, AssetLoadCallback callback, void* userData, AssetPriority priority, Args&... args);
 	};
 
 	class RD_API ECSSystem{
@@ -924,9 +1109,38 @@ namespace RainDrop{
 	 * 
 	 * @param name the name of the event
 	 * @param dataSize the size of the data carried by the event
+	 * @param coalescing how the triggers of the event are merged during a frame
+	 * @param accumulate the function used to merge two payloads, required with EventCoalescing::Accumulate (see accumulateEvent<T>)
+	 * @param delivery when the callbacks are called, immediate events cannot be coalesced, the callbacks of parallel events must not subscribe nor unsubscribe
+	 * @return return the id of the event, if the event name is already used, it will return the id of the already existing event
+	 */
+	EventID RD_API registerEvent(const char* name, uint32_t dataSize = 0, EventCoalescing coalescing = EventCoalescing::KeepAll, void(*accumulate)(void*, const void*, uint16_t) = nullptr, EventDelivery delivery = EventDelivery::Deferred);
+
+	/**
+	 * @brief register a non coalesced event with the given delivery mode
+	 * 
+	 * @param name the name of the event
+	 * @param dataSize the size of the data carried by the event
+	 * @param delivery when the callbacks are called
 	 * @return return the id of the event, if the event name is already used, it will return the id of the already existing event
 	 */
-	EventID RD_API registerEvent(const char* name, uint32_t dataSize = 0);
+	EventID RD_API registerEvent(const char* name, uint32_t dataSize, EventDelivery delivery);
+
+	/**
+	 * @brief accumulate function that sum the payloads as arrays of T
+	 * 
+	 * @param dst the queued payload
+	 * @param src the new payload
+	 * @param size the size of the payloads in bytes
+	 */
+	template<typename T>
+	void accumulateEvent(void* dst, const void* src, uint16_t size){
+		T* d = static_cast<T*>(dst);
+		const T* s = static_cast<const T*>(src);
+		for (uint16_t i=0; i<size / sizeof(T); i++){
+			d[i] += s[i];
+		}
+	}
 
 	/**
 	 * @brief get the id of an event from it name
@@ -1003,6 +1217,39 @@ namespace RainDrop{
 	 */
 	void RD_API unsubscribeEvent(EventID id, bool(*MTcallback)(void*, void*));	
 
+	/**
+	 * @brief subscribe to every trigger of an event at once, the callback is called once per frame with the payloads queued this frame
+	 * 
+	 * @param id the id of the event to subscribe to
+	 * @param FNcallback a pointer to the batch callback (void foo(void* payloads, uint32_t count)), the payloads are contiguous and in trigger order
+	 */
+	void RD_API subscribeEventBatch(EventID id, void(*FNcallback)(void*, uint32_t));
+
+	/**
+	 * @brief subscribe to every trigger of an event at once, the callback is called once per frame with the payloads queued this frame
+	 * 
+	 * @param id the id of the event to subscribe to
+	 * @param instance the instance pointer of the callback methode
+	 * @param MTcallback a pointer to the batch callback (static void foo(void* instance, void* payloads, uint32_t count))
+	 */
+	void RD_API subscribeEventBatch(EventID id, void* instance, void(*MTcallback)(void*, void*, uint32_t));
+
+	/**
+	 * @brief unsubscribe a batch callback from an event
+	 * 
+	 * @param id the event to unsubscribe from
+	 * @param FNcallback the pointer to the batch callback
+	 */
+	void RD_API unsubscribeEventBatch(EventID id, void(*FNcallback)(void*, uint32_t));
+
+	/**
+	 * @brief unsubscribe a batch callback from an event
+	 * 
+	 * @param id the event to unsubscribe from
+	 * @param MTcallback the pointer to the batch callback
+	 */
+	void RD_API unsubscribeEventBatch(EventID id, void(*MTcallback)(void*, void*, uint32_t));
+
 	/**
 	 * @brief get the size of the data carriend by an event
 	 * 
@@ -1021,6 +1268,9 @@ namespace RainDrop{
 
 	// intern
 	void* RD_API __eventAllocStack(uint32_t size);
+
+	// intern
+	void* RD_API __eventAllocPayload(EventID id);
 	
 	/**
 	 * @brief trigger an event and send the data as a void pointer
@@ -1038,7 +1288,7 @@ namespace RainDrop{
 	 */
 	template<typename... Args>
 	void RD_API triggerEvent(EventID id, Args... args){
-		void* data = __eventAllocStack(getEventDataSize(id));
+		void* data = __eventAllocPayload(id);
 		__convertToVoid(data, args...);
 		triggerEventPtr(id, data);
 	}
@@ -1054,8 +1304,180 @@ namespace RainDrop{
 		triggerEvent(getEventID(name), args...);
 	}
 
+	// intern
+	EventTimerID RD_API __scheduleEvent(EventID id, bool frames, double delay, double interval);
+
+	// intern
+	void* RD_API __eventTimerPayload(EventTimerID timer);
+
+	// intern
+	template<typename... Args>
+	EventTimerID __scheduleEvent(EventID id, bool frames, double delay, double interval, Args... args){
+		EventTimerID timer = __scheduleEvent(id, frames, delay, interval);
+		if constexpr (sizeof...(Args) > 0){
+			__convertToVoid(__eventTimerPayload(timer), args...);
+		}
+		return timer;
+	}
+
+	/**
+	 * @brief trigger an event after a delay
+	 * 
+	 * @param id the id of the event to trigger
+	 * @param seconds the delay in seconds
+	 * @param args the data to send, copied when the timer is created
+	 * @return the handle of the timer, used to cancel it
+	 */
+	template<typename... Args>
+	EventTimerID RD_API triggerEventDelayed(EventID id, double seconds, Args... args){
+		return __scheduleEvent(id, false, seconds, 0.0, args...);
+	}
+
+	/**
+	 * @brief trigger an event after a number of frames
+	 * 
+	 * @param id the id of the event to trigger
+	 * @param frames the number of calls to updateEvents before the event is triggered
+	 * @param args the data to send, copied when the timer is created
+	 * @return the handle of the timer, used to cancel it
+	 */
+	template<typename... Args>
+	EventTimerID RD_API triggerEventAfterFrames(EventID id, uint32_t frames, Args... args){
+		return __scheduleEvent(id, true, static_cast<double>(frames), 0.0, args...);
+	}
+
+	/**
+	 * @brief trigger an event every interval until the timer is cancelled
+	 * 
+	 * @param id the id of the event to trigger
+	 * @param interval the interval in seconds
+	 * @param args the data to send, copied when the timer is created
+	 * @return the handle of the timer, used to cancel it
+	 */
+	template<typename... Args>
+	EventTimerID RD_API triggerEventRepeating(EventID id, double interval, Args... args){
+		return __scheduleEvent(id, false, interval, interval, args...);
+	}
+
+	/**
+	 * @brief trigger an event every given number of frames until the timer is cancelled
+	 * 
+	 * @param id the id of the event to trigger
+	 * @param frames the number of frames between two triggers
+	 * @param args the data to send, copied when the timer is created
+	 * @return the handle of the timer, used to cancel it
+	 */
+	template<typename... Args>
+	EventTimerID RD_API triggerEventEveryFrames(EventID id, uint32_t frames, Args... args){
+		return __scheduleEvent(id, true, static_cast<double>(frames), static_cast<double>(frames), args...);
+	}
+
+	/**
+	 * @brief cancel a delayed or repeating trigger
+	 * 
+	 * @param timer the handle returned when the trigger was scheduled
+	 * @return false if the timer already expired or was already cancelled
+	 */
+	bool RD_API cancelEventTimer(EventTimerID timer);
+
 	void RD_API updateEvents();
 
+	/**
+	 * @brief record every event trigger into a binary journal, the file is written from a background thread
+	 * 
+	 * @param path the path of the journal file
+	 */
+	void RD_API startEventRecording(const char* path);
+
+	/**
+	 * @brief stop the recording and flush the journal
+	 * 
+	 */
+	void RD_API stopEventRecording();
+
+	/**
+	 * @brief get the count of triggers dropped from the journal because the writer could not keep up, a journal with drops does not replay the session
+	 * 
+	 * @return uint64_t the count of the running recording, or of the last one once stopped
+	 */
+	uint64_t RD_API getEventRecordingDroppedCount();
+
+	/**
+	 * @brief replay a journal, the live input is suppressed and the recorded input events are triggered again at the same frames
+	 * 
+	 * @param path the path of the journal file
+	 */
+	void RD_API startEventReplay(const char* path);
+
+	/**
+	 * @brief stop the replay and give the control back to the live input
+	 * 
+	 */
+	void RD_API stopEventReplay();
+
+	/**
+	 * @brief check if a journal is being replayed, the replay stops by itself at the end of the journal
+	 */
+	bool RD_API isEventReplaying();
+
+	/**
+	 * @brief get the dispatch stats of the event during the last frame
+	 * 
+	 * @param event the id of the event
+	 * @return the stats, the counters are zero when the engine is built without HERMES_PROFILE
+	 */
+	EventStats RD_API getEventStats(EventID event);
+
+	/**
+	 * @brief get the latency histograms of the callbacks of the event
+	 * 
+	 * @param event the id of the event
+	 * @param stats the array filled in subscription order (callbacks then batch callbacks), nullptr to only get the count
+	 * @param maxCount the size of the array
+	 * @return size_t the callback count of the event, the counters are zero when the engine is built without HERMES_PROFILE
+	 */
+	size_t RD_API getEventCallbackStats(EventID event, EventCallbackStats* stats, size_t maxCount);
+
+	/**
+	 * @brief dump the dispatch stats of the triggered events at the end of every frame
+	 * 
+	 * @param path the path of the dump file, nullptr stops the dump
+	 * @param format CSV (one row per event and per frame, followed by one row per callback) or JSON (one object per frame and per line)
+	 */
+	void RD_API setEventStatsDump(const char* path, EventStatsFormat format = EventStatsFormat::CSV);
+
+	/**
+	 * @brief get the live memory counters of a category, the frame counters are rolled by beginFrame
+	 * 
+	 * @param category the category
+	 * @return the stats of the category
+	 */
+	MemoryStats RD_API getMemoryStats(MemoryCategory category);
+
+	/**
+	 * @brief set the budgets of a category, the budget callback is called when the live bytes go above one of them
+	 * 
+	 * @param category the category
+	 * @param softBudget the soft budget in bytes, 0 to disable it
+	 * @param hardBudget the hard budget in bytes, 0 to disable it
+	 */
+	void RD_API setMemoryBudget(MemoryCategory category, uint64_t softBudget, uint64_t hardBudget);
+
+	/**
+	 * @brief set the function called when a category goes over budget, it is called by the allocating thread, once per crossing
+	 * 
+	 * @param callback the callback (category, live bytes, exceeded budget, true for the hard budget), nullptr to remove it
+	 */
+	void RD_API setMemoryBudgetCallback(void(*callback)(MemoryCategory, uint64_t, uint64_t, bool));
+
+	/**
+	 * @brief get the name of a memory category
+	 * 
+	 * @param category the category
+	 * @return the name
+	 */
+	const char* RD_API getMemoryCategoryName(MemoryCategory category);
+
 	/**
 	 * @brief check if the given key is pressed on the keyboard
 	 * 
@@ -1516,16 +1938,32 @@ namespace RainDrop{
 	}
 
 	/**
-	 * @brief get a pointer to an asset
+	 * @brief get a counted handle to an asset, load the asset if it was not loaded before
 	 * 
-	 * @param typeID the id of the asset
+	 * @param typeID the id of the asset type
 	 * @param name the name of the asset
 	 * @param data the data of the asset, will be used only to initialize the asset if it not exist
-	 * @param count the count of references to this asset
-	 * @param removeAsset the callback to call when the ref count goes down to zero
-	 * @return void* the asset
+	 * @return AssetHandle the handle, releaseAsset must be called once with it
+	 */
+	AssetHandle RD_API acquireAsset(uint64_t typeID, const char* name, const AssetData &data);
+
+	/**
+	 * @brief count one more reference to the asset of a counted handle, lock free
+	 */
+	void RD_API retainAsset(AssetHandle handle);
+
+	/**
+	 * @brief drop a reference to an asset, the asset is destroyed by updateEvents once there are no more references
+	 */
+	void RD_API releaseAsset(AssetHandle handle);
+
+	/**
+	 * @brief get the asset of a handle, an index and a generation check
+	 * 
+	 * @param handle a counted or uncounted handle
+	 * @return void* the asset, nullptr if the asset was released or is not loaded, the pointer stays valid until the next updateEvents
 	 */
-	void* RD_API getAssetPtr(uint64_t typeID, const char* name, AssetData &data, uint16_t*& count, void (**removeAsset)(const char*));
+	void* RD_API getAssetPtr(AssetHandle handle);
 
 	/**
 	 * @brief get a reference to an asset
@@ -1539,16 +1977,118 @@ namespace RainDrop{
 	template<typename T, typename... Args>
 	AssetReference<T> RD_API getAsset(const char* name, Args&... args){
 		AssetReference<T> ref;
-		ref.asset = createAssetPtr(typeid(T).hash_code(), name, AssetData(args...), &ref.count, &ref.removeAsset);
+		ref.handle = acquireAsset(typeid(T).hash_code(), name, AssetData(args...));
+		return ref;
+	}
+
+	/**
+	 * @brief load an asset on the loader threads, the call returns immediately with a handle to the pending asset
+	 * 
+	 * @param typeID the id of the asset type
+	 * @param name the name of the asset
+	 * @param data the data of the asset, copied, only used if the asset is not loaded yet
+	 * @param callback called when the load ends, nullptr to poll getAssetState instead
+	 * @param userData given to the callback
+	 * @param priority the queued loads start by priority, a load already queued at a lower one is raised
+	 * @return AssetHandle the handle, releaseAsset must be called once with it, getAssetPtr returns nullptr until the load ends
+	 */
+	AssetHandle RD_API acquireAssetAsync(uint64_t typeID, const char* name, const AssetData &data, AssetLoadCallback callback = nullptr, void* userData = nullptr, AssetPriority priority = AssetPriority::Visible);
+
+	/**
+	 * @brief get a reference to an asset loading on the loader threads, the call returns immediately
+	 * 
+	 * @tparam T the type of the asset
+	 * @tparam Args the args needed to initialize the asset, only if the asset do not exist before this call
+	 * @param name the name of the asset
+	 * @param callback called when the load ends, nullptr to poll getAssetState instead
+	 * @param userData given to the callback
+	 * @param priority the queued loads start by priority, a load already queued at a lower one is raised
+	 * @param args 
+	 * @return AssetReference<T> the pending asset, the operator-> returns nullptr until the load ends
+	 */
+	template<typename T, typename... Args>
+	AssetReference<T> RD_API getAssetAsync(const char* name, AssetLoadCallback callback, void* userData, AssetPriority priority, Args&... args){
+		AssetReference<T> ref;
+		ref.handle = acquireAssetAsync(typeid(T).hash_code(), name, AssetData(args...), callback, userData, priority);
 		return ref;
 	}
 
 	/**
-	 * @brief destroy all assets in the engine
+	 * @brief move a load not started yet to an other priority, ex: demote the assets the camera moved away from
+	 * raising a load raises the loads of its dependencies too
+	 * 
+	 * @param name the name of the asset
+	 * @return true if the asset was waiting to load
+	 */
+	bool RD_API setAssetLoadPriority(const char* name, AssetPriority priority);
+
+	/**
+	 * @brief end a load not started yet as failed, the callbacks are called with loaded false, the next request of the asset loads it again
+	 * 
+	 * @param name the name of the asset
+	 * @return true if the asset was waiting to load, false if the load already started
+	 */
+	bool RD_API cancelAssetLoad(const char* name);
+
+	/**
+	 * @brief cap the work of the asset loads in each frame, the critical loads are never held back
+	 * 
+	 * @param bytes the loader threads start no more load once the assets loaded since the last updateEvents reach this size, reported by AssetFactory::getSize, 0 for no cap
+	 * @param microseconds the time updateEvents spends calling the load callbacks, the remaining ones are called by the next frames, 0 for no cap
+	 */
+	void RD_API setAssetFrameBudget(size_t bytes, uint32_t microseconds);
+
+	/**
+	 * @brief get the loading state of an asset
+	 * 
+	 * @param name the name of the asset
+	 * @return AssetState Unloaded if there is no asset with this name
+	 */
+	AssetState RD_API getAssetState(const char* name);
+
+	/**
+	 * @brief destroy all assets in the engine, wait for the loads in flight
 	 * 
 	 */
 	void RD_API clearAssets();
 
+	/**
+	 * @brief map an asset pack built by the OdinPacker tool, the assets of the pack are then created with AssetFactory::createFromPack
+	 * the packs mounted last are searched first, they stay mapped until shutdown
+	 * 
+	 * @param path the path to the pack
+	 */
+	void RD_API mountAssetPack(const char* path);
+
+	/**
+	 * @brief keep the assets without reference loaded, until their total size reported by AssetFactory::getSize goes over the budget
+	 * then the least recently released ones are destroyed
+	 * 
+	 * @param bytes the budget, 0 to destroy the assets as soon as they have no reference (default)
+	 */
+	void RD_API setAssetCacheBudget(size_t bytes);
+
+	/**
+	 * @brief get the total size of the cached assets, the ones without reference
+	 * 
+	 * @return size_t the size in bytes
+	 */
+	size_t RD_API getAssetCacheSize();
+
+	/**
+	 * @brief reload the assets when their file changes, only supported on linux
+	 * the new assets are created on the loader threads with the data of their first load, and replace the previous ones for every reference in updateEvents
+	 * 
+	 * @param root the watched directory, the asset names must be the file paths from it, ex: watchAssets(".data") for ".data/images/ship.png"
+	 * @param debounceMilliseconds the time without changes to wait before reloading a file
+	 */
+	void RD_API watchAssets(const char* root, uint32_t debounceMilliseconds = 200);
+
+	/**
+	 * @brief stop reloading the assets when their file changes
+	 */
+	void RD_API unwatchAssets();
+
 	// ==========================================================
 	// ==                         SOUNDID                        ==
 	// ==========================================================
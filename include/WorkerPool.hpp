@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <pthread.h>
+
+// the engine worker pool, a fixed set of threads running short tasks
+// the tasks are grouped, the owner of a group waits for its own tasks only
+class WorkerPool{
+	public:
+		using Task = void(*)(void*);
+
+		// a set of tasks waited together, it must outlive its tasks
+		struct Group{
+			std::atomic<uint32_t> pending{0};
+		};
+
+		// a null thread count use one thread per hardware thread minus the calling one
+		WorkerPool(uint32_t threadCount = 0);
+		~WorkerPool();
+
+		void submit(Task task, void* data, Group* group = nullptr);
+
+		// wait until every task of the group is done, the calling thread runs the queued tasks of the group meanwhile
+		void wait(Group &group);
+
+		uint32_t getThreadCount() const {return threadCount;}
+
+	private:
+		struct Job{
+			Task task = nullptr;
+			void* data = nullptr;
+			Group* group = nullptr;
+		};
+
+		static void* workerThread(void* pool);
+		void run(const Job &job);
+
+		// remove the job at the given queue position, keeping the queue order, the mutex must be locked
+		Job take(uint32_t position);
+
+		pthread_t* threads = nullptr;
+		uint32_t threadCount = 0;
+
+		// guarded by the mutex
+		Job* jobs = nullptr; // ring buffer
+		uint32_t jobCapacity = 0;
+		uint32_t jobStart = 0;
+		uint32_t jobCount = 0;
+		bool running = true;
+
+		pthread_mutex_t mutex;
+		pthread_cond_t workCondition;
+		pthread_cond_t doneCondition;
+};
@@ -4,6 +4,8 @@
 #include "ECS.hpp"
 #include "RainDrop.hpp"
 
+class WorkerPool;
+
 namespace RainDrop{
 	enum class RenderBuffer{
 		None,
@@ -17,6 +19,7 @@ namespace RainDrop{
 		bool keyPressed[static_cast<int>(Key::K_MAX)];
 		bool buttonPressed[static_cast<int>(MouseButton::MAX)];
 		vec2<float> mousePos;
+		WorkerPool* workers = nullptr; // the engine worker pool
 	};
 
 	Core& getInstance();
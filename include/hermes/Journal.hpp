@@ -0,0 +1,110 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <pthread.h>
+
+// binary event journal
+//
+// header  : "HRMJ", u16 version, u16 event count, then for each event : u16 id, u16 data size, u16 name length, name
+// records : u16 id (JOURNAL_EXTERNAL_BIT set for external triggers) followed by the event payload
+//           JOURNAL_FRAME_MARKER ends a frame
+//           JOURNAL_REGISTER_MARKER followed by an event description (same layout as in the header) for events registered while recording
+// all values are stored in the host byte order (little endian on every supported target)
+
+static constexpr uint16_t JOURNAL_VERSION = 1;
+static constexpr uint16_t JOURNAL_FRAME_MARKER = 0xFFFF;
+static constexpr uint16_t JOURNAL_REGISTER_MARKER = 0xFFFE;
+static constexpr uint16_t JOURNAL_EXTERNAL_BIT = 0x8000;
+
+// append only journal writer, the file is written from a background thread
+// the memory is bounded to a fixed count of chunks, records are dropped (and counted) instead of stalling the caller when the writer is late
+// the frame markers are never dropped, they wait for a free chunk and are written before the next record, so the frames never merge
+class JournalWriter{
+	public:
+		static constexpr size_t CHUNK_SIZE = 128 * 1024;
+		static constexpr uint32_t CHUNK_COUNT = 8;
+
+		JournalWriter(const char* path);
+		~JournalWriter();
+
+		// make room for size bytes written by the next write calls, false (and counted as a dropped record) if it cannot be buffered
+		// the writes of a multi part record go after a successful reserve of its whole size, so the record is written whole or not at all
+		bool reserve(size_t size);
+		void write(const void* data, size_t size);
+
+		// write a record atomically, the whole record is dropped if it cannot be buffered
+		void writeRecord(uint16_t id, const void* payload, uint16_t size);
+
+		// end a frame
+		void writeFrame();
+
+		// push the current chunk to the writer thread
+		void flush();
+
+		uint64_t getDroppedRecordCount() const {return droppedRecords;}
+
+	private:
+		struct Chunk{
+			char* data = nullptr;
+			size_t size = 0;
+			Chunk* next = nullptr;
+		};
+
+		static void* writerThread(void* writer);
+		bool acquireChunk();
+
+		// the current chunk has room for size bytes, after the pending frame markers
+		bool fit(size_t size);
+		bool writePendingFrames();
+
+		FILE* file = nullptr;
+		Chunk chunks[CHUNK_COUNT];
+		Chunk* current = nullptr;
+
+		// guarded by the mutex
+		Chunk* freeChunks = nullptr;
+		Chunk* fullChunks = nullptr;
+		Chunk* lastFullChunk = nullptr;
+		bool running = true;
+
+		pthread_t thread;
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+		uint64_t droppedRecords = 0;
+		uint32_t pendingFrames = 0; // the frame markers waiting for a chunk
+};
+
+// sequential journal reader, the records are streamed from the file
+class JournalReader{
+	public:
+		struct EventInfo{
+			uint16_t id = 0;
+			uint16_t dataSize = 0;
+			char* name = nullptr;
+		};
+
+		JournalReader(const char* path);
+		~JournalReader();
+
+		uint16_t getEventCount() const {return eventCount;}
+		const EventInfo& getEvent(uint16_t index) const {return events[index];}
+
+		// read the next record id, return false at the end of the journal
+		bool readID(uint16_t &id);
+		bool readPayload(void* data, uint16_t size);
+
+		bool isAtEnd();
+
+		// read the event description following a JOURNAL_REGISTER_MARKER and add it to the event table
+		bool readEvent();
+
+	private:
+		void close();
+		bool readEventInfo(EventInfo &event);
+
+		FILE* file = nullptr;
+		EventInfo* events = nullptr;
+		uint16_t eventCount = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+
+// hierarchical timing wheel, insertion, removal and expiration are O(1) amortized whatever the number of pending timers
+// the timers are identified by an index chosen by the owner, the wheel only stores the intrusive links of each index
+class TimingWheel{
+	public:
+		using Tick = uint64_t;
+
+		static constexpr uint32_t INVALID = UINT32_MAX;
+		static constexpr uint32_t SLOT_BITS = 8;
+		static constexpr uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+		static constexpr uint32_t LEVEL_COUNT = 4;
+
+		TimingWheel();
+		~TimingWheel();
+
+		// make sure the timers index [0, capacity) can be inserted
+		void reserve(uint32_t capacity);
+
+		// schedule the timer, a timer expiring in the past or at the current tick will expire at the next one
+		void insert(uint32_t timer, Tick expire);
+		void remove(uint32_t timer);
+
+		// set the current tick without expiring anything, only valid when the wheel is empty
+		void reset(Tick tick);
+
+		// advance the wheel up to the given tick and call onExpire(timer) for every expired timer
+		// the timers are removed from the wheel before the callback, so they can be inserted again from it
+		// the callback can also remove the timers expiring after it in the same tick
+		template<typename F>
+		void advance(Tick tick, F &&onExpire){
+			// nothing to expire, jump directly to the requested tick
+			if (count == 0){
+				if (tick > current) current = tick;
+				return;
+			}
+
+			while (current < tick){
+				// skip the spans of the empty levels, nothing can expire nor cascade in them
+				Tick skip = current;
+				for (uint32_t level=0; level<LEVEL_COUNT && levelCount[level] == 0; level++){
+					uint32_t shift = SLOT_BITS * (level + 1);
+					skip = (((current >> shift) + 1) << shift) - 1;
+				}
+
+				if (skip >= tick){
+					current = tick;
+					break;
+				}
+
+				current = skip + 1;
+
+				uint32_t index = static_cast<uint32_t>(current & (SLOT_COUNT - 1));
+				if (index == 0) cascade(1);
+
+				// the expired timers are popped one at a time, the callback may cancel or insert any timer
+				expire(index);
+				uint32_t timer;
+				while ((timer = slots[EXPIRING]) != INVALID){
+					remove(timer);
+					onExpire(timer);
+				}
+
+				if (count == 0){
+					current = tick;
+					break;
+				}
+			}
+		}
+
+		Tick getCurrentTick() const {return current;}
+		uint32_t getCount() const {return count;}
+
+	private:
+		struct Node{
+			Tick expire = 0;
+			uint32_t next = INVALID;
+			uint32_t prev = INVALID;
+			uint32_t slot = INVALID; // level * SLOT_COUNT + slot index, INVALID when not scheduled
+		};
+
+		void place(uint32_t timer);
+		void cascade(uint32_t level);
+		uint32_t detach(uint32_t slot);
+		void expire(uint32_t index);
+
+		// extra slot holding the timers of the tick being expired
+		static constexpr uint32_t EXPIRING = LEVEL_COUNT * SLOT_COUNT;
+
+		Node* nodes = nullptr;
+		uint32_t capacity = 0;
+		uint32_t count = 0;
+		uint32_t slots[LEVEL_COUNT * SLOT_COUNT + 1];
+		uint32_t levelCount[LEVEL_COUNT + 1] = {};
+		Tick current = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include <atomic>
+#include <cstddef>
+
+// transient allocator tied to the frame lifecycle, with frameCount frames in flight
+// each frame owns a region, the memory pushed during the frame K stays valid until the frame K + frameCount begins
+// push is lock free and can be called from any thread, beginFrame must not run concurrently with push
+class FrameAllocator{
+	public:
+		FrameAllocator(size_t frameSize, uint32_t frameCount = 2);
+		~FrameAllocator();
+
+		// start the next frame, the region of the frame frameCount frames ago is reused
+		void beginFrame();
+
+		// return nullptr if the region of the current frame is full
+		void* push(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template<typename T>
+		T* push(size_t count = 1){
+			return static_cast<T*>(push(sizeof(T) * count, alignof(T)));
+		}
+
+		size_t getCurrentUsedSize() const;
+		size_t getMaxSize() const; // the size of a frame region
+		uint32_t getFrameCount() const;
+		uint64_t getFrame() const;
+
+	private:
+		struct Region{
+			char* data = nullptr;
+			std::atomic<size_t> used{0};
+		};
+
+		Region* regions = nullptr;
+		Region* current = nullptr;
+		size_t frameSize = 0;
+		uint32_t frameCount = 0;
+		uint64_t frame = 0;
+};
@@ -15,43 +15,106 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
-#include <unordered_map>
+#include <cstdint>
+#include "SizeClassAllocator.hpp"
 
 class Horreum{
 	public:
+		// the subsystem an allocation is accounted to, stored in the block header
+		enum class Category : uint8_t{
+			User,
+			ECS,
+			Events,
+			Assets,
+			Audio,
+			Render,
+			MAX
+		};
+
+		// the live counters of a category, exact (unlike the call sites)
+		struct CategoryStats{
+			uint64_t liveBytes = 0;
+			uint64_t peakBytes = 0;
+			uint64_t liveCount = 0;
+			uint64_t frameAllocations = 0; // the allocations (and reallocations) made during the last frame
+			uint64_t totalAllocations = 0;
+			uint64_t softBudget = 0;
+			uint64_t hardBudget = 0;
+		};
+
+		// called by the allocating thread when the live bytes of a category go above one of its budgets
+		using BudgetCallback = void(*)(Category category, uint64_t liveBytes, uint64_t budget, bool hard);
+
+		// set the category of the allocations made by the calling thread for its lifetime
+		class CategoryScope{
+			public:
+				CategoryScope(Category category);
+				~CategoryScope();
+
+			private:
+				Category previous;
+		};
+
+		// a call site of the allocation macros, the counters are estimated from the sampled allocations
+		struct CallSite{
+			const char* file = nullptr;
+			const char* function = nullptr;
+			int line = 0;
+			uint64_t liveBytes = 0;
+			uint64_t liveCount = 0;
+			uint64_t totalBytes = 0;
+			uint64_t totalCount = 0;
+		};
+
+		static constexpr uint32_t MAX_CALL_SITE_COUNT = 4096;
+		static constexpr uint32_t DEFAULT_SAMPLE_RATE = 64;
+
 		Horreum();
 		~Horreum();
 
 		static Horreum& getInstance();
+
+		// with HORREUM_ALLOC_LOG, the allocations report is written into the log file at exit
 		static void initialize(const std::filesystem::path &logFile = "allocationLog.txt");
 
+		// malloc uses the category of the calling thread, realloc keeps the category of the block
 		static void* malloc(size_t size);
+		static void* malloc(size_t size, Category category);
 		static void* realloc(void *src, size_t newSize);
 		static void free(void *ptr);
 
+		// tracked allocations, the call site is interned the first time one of its allocations is sampled
+		// the tracked blocks carry their call site in their header, there is no table of the live pointers
 		static void* mallocLog(size_t size, const char *file, const char *functionName, int line);
 		static void* reallocLog(void *src, size_t newSize, const char *file, const char *functionName, int line);
 		static void freeLog(void *ptr);
 
-	private:
+		// track one allocation out of rate, per thread, a rate of 1 tracks everything
+		static void setSampleRate(uint32_t rate);
+		static uint32_t getSampleRate();
+
+		// copy the call sites (merged by file and line, sorted by live bytes), return the call site count
+		static size_t getCallSites(CallSite* sites, size_t maxCount);
+
+		// write the call sites as CSV
+		static void writeReport(std::ostream &stream);
+
+		static void setCategory(Category category);
+		static Category getCategory();
+		static Category getCategory(void* ptr);
+		static const char* getCategoryName(Category category);
+		static CategoryStats getCategoryStats(Category category);
 
-		#ifdef HORREUM_ALLOC_LOG
-			struct AllocationData{
-				bool error = false;
-				std::string function;
-				std::string file;
-				int line;
-				size_t size;
-			};
-
-			uint32_t allocationCount = 0;
-			uint32_t freeCount = 0;
-			std::unordered_map<void*, AllocationData> allocMap;
-			std::ofstream allocLogFile;
-
-			void closeFile();
-			void writeData(AllocationData &data);
-		#endif
+		// zero disables a budget, the callback fires once each time the live bytes cross a budget upward
+		static void setBudget(Category category, uint64_t softBudget, uint64_t hardBudget);
+		static void setBudgetCallback(BudgetCallback callback);
+
+		// roll the per frame counters
+		static void beginFrame();
+
+	private:
+		std::filesystem::path logFile;
+		bool initialized = false;
 };
 
 #ifdef HORREUM_ALLOC_LOG
@@ -62,4 +125,4 @@ class Horreum{
 	#define HRM_MALLOC(size) ::Horreum::malloc(size)
 	#define HRM_REALLOC(ptr, size) ::Horreum::realloc(ptr, size)
 	#define HRM_FREE(ptr) ::Horreum::free(ptr)
-#endif
\ No newline at end of file
+#endif
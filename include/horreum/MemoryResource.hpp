@@ -0,0 +1,87 @@
+#pragma once
+
+#include <iostream>
+#include <atomic>
+#include <memory_resource>
+#include <pthread.h>
+#include "Horreum.hpp"
+#include "PoolAllocator.hpp"
+#include "StackAllocator.hpp"
+#include "VirtualArena.hpp"
+
+// std::pmr adaptors over the Horreum allocators, so the standard containers can draw from them
+// the allocations are accounted to the category of the resource, whatever the thread using the container
+
+// general purpose resource, the size class allocator
+// the alignments above 16 bytes go to the aligned operator new
+class HorreumResource : public std::pmr::memory_resource{
+	public:
+		HorreumResource(Horreum::Category category = Horreum::Category::User);
+
+		Horreum::Category getCategory() const {return category;}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		Horreum::Category category;
+};
+
+// node resource for the lists, sets and maps, one pool per 16 bytes size step up to MAX_POOLED_SIZE
+// the pools are created on first use and are thread safe, the larger blocks go to the upstream resource
+class PoolResource : public std::pmr::memory_resource{
+	public:
+		static constexpr size_t MAX_POOLED_SIZE = 256;
+		static constexpr size_t POOL_STEP = 16;
+		static constexpr size_t POOL_COUNT = MAX_POOLED_SIZE / POOL_STEP;
+
+		// firstPageCount is the element count of the first page of each pool
+		PoolResource(Horreum::Category category = Horreum::Category::User, size_t firstPageCount = 64);
+		~PoolResource();
+
+		PoolResource(const PoolResource&) = delete;
+		PoolResource& operator=(const PoolResource&) = delete;
+
+		std::pmr::memory_resource* getUpstream(){return &upstream;}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		PoolAllocator* getPool(size_t index);
+
+		HorreumResource upstream;
+		size_t firstPageCount;
+		std::atomic<PoolAllocator*> pools[POOL_COUNT] = {};
+		pthread_mutex_t poolMutex;
+};
+
+// monotonic resource over a stack allocator, not owned, deallocate does nothing
+// the memory is released in bulk by rolling back or clearing the stack, not thread safe
+class StackResource : public std::pmr::memory_resource{
+	public:
+		StackResource(StackAllocator &allocator) : allocator{allocator}{}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		StackAllocator &allocator;
+};
+
+// monotonic resource over a virtual arena, not owned, deallocate does nothing
+// the memory is released in bulk by rolling back or clearing the arena, not thread safe
+class ArenaResource : public std::pmr::memory_resource{
+	public:
+		ArenaResource(VirtualArena &arena) : arena{arena}{}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		VirtualArena &arena;
+};
@@ -1,11 +1,18 @@
 #pragma once
 
 #include <iostream>
-#include <queue>
-#include <list>
+#include <atomic>
+#include <pthread.h>
+#include "Horreum.hpp"
 
+// fixed size elements allocator, safe to use from several threads
+// the free list is stored inside the free elements and popped / pushed with a tagged compare and swap, so getElement and restoreElement never lock nor allocate
+// when exhausted the pool grows by a new page, twice as large as the previous one, the pages are only released by the destructor
 class PoolAllocator{
 	public:
+		static constexpr uint32_t MAX_PAGE_COUNT = 24;
+
+		// elementCount is the size of the first page, the pages are accounted to the category of the constructing thread
 		PoolAllocator(size_t elementSize, size_t elementCount);
 		~PoolAllocator();
 
@@ -14,13 +21,56 @@ class PoolAllocator{
 
 		size_t getRemainingElementCount();
 		size_t getElementSize();
-		size_t getMaxElementSize();
+		size_t getMaxElementSize(); // the current capacity, in elements
 		size_t getUsedElementsCount();
 
+		// a per thread cache of elements, taken from and given back to the pool by batches
+		// it cuts the contention on the pool head when several threads allocate at high rate, a magazine must only be used by one thread
+		class Magazine{
+			public:
+				static constexpr uint32_t CAPACITY = 32;
+
+				Magazine(PoolAllocator &pool);
+				~Magazine();
+
+				void* getElement();
+				void restoreElement(void* element);
+
+			private:
+				PoolAllocator &pool;
+				void* elements[CAPACITY];
+				uint32_t count = 0;
+		};
+
 	private:
-		std::queue<void*> unusedElements;
-		std::list<void*> elements;
-		size_t maxElementCount;
-		size_t elementUsedCount = 0;
+		static constexpr uint32_t INVALID = UINT32_MAX;
+
+		// the head is the index of the first free element in the low bits and a tag incremented by every update in the high bits
+		static uint64_t pack(uint32_t index, uint32_t tag){return (static_cast<uint64_t>(tag) << 32) | index;}
+		static uint32_t getHeadIndex(uint64_t head){return static_cast<uint32_t>(head);}
+		static uint32_t getHeadTag(uint64_t head){return static_cast<uint32_t>(head >> 32);}
+
+		char* getAddress(uint32_t index);
+		uint32_t getIndex(void* element);
+		std::atomic<uint32_t>& getLink(uint32_t index);
+
+		// push the chain [first, last], already linked, in one swap
+		void pushChain(uint32_t first, uint32_t last, uint32_t count);
+
+		// pop up to count elements in one swap, the chain is written into elements, return the popped count
+		uint32_t popChain(void** elements, uint32_t count);
+
+		bool grow();
+
 		size_t elementSize;
-};
\ No newline at end of file
+		uint32_t firstPageCount;
+		Horreum::Category category;
+
+		// the page i holds firstPageCount << i elements, written once under the grow mutex before being published
+		char* pages[MAX_PAGE_COUNT] = {};
+		std::atomic<uint32_t> pageCount{0};
+
+		std::atomic<uint64_t> head;
+		std::atomic<size_t> elementUsedCount{0};
+		pthread_mutex_t growMutex;
+};
@@ -2,13 +2,25 @@
 
 #include <iostream>
 
+// two stacks sharing one buffer, the left one grows from the start and the right one from the end
 class SharedStackAllocator{
 	public:
 		SharedStackAllocator(size_t size);
 		~SharedStackAllocator();
 
-		void* pushLeft(size_t size);
-		void* pushRight(size_t size);
+		// return nullptr if the stacks would overlap, alignment must be a power of two
+		void* pushLeft(size_t size, size_t alignment = 1);
+		void* pushRight(size_t size, size_t alignment = 1);
+
+		template<typename T>
+		T* pushLeft(size_t count = 1){
+			return static_cast<T*>(pushLeft(sizeof(T) * count, alignof(T)));
+		}
+
+		template<typename T>
+		T* pushRight(size_t count = 1){
+			return static_cast<T*>(pushRight(sizeof(T) * count, alignof(T)));
+		}
 		 
 		size_t getCurrentUsedSizeLeft() const;
 		size_t getCurrentUsedSizeRight() const;
@@ -25,4 +37,4 @@ class SharedStackAllocator{
 		size_t maxSize = 0;
 		size_t sizeUsedLeft = 0;
 		size_t sizeUsedRight = 0;
-};
\ No newline at end of file
+};
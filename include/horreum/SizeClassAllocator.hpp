@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+
+// general purpose allocator behind HRM_MALLOC, HRM_REALLOC and HRM_FREE
+// the small blocks (up to MAX_SMALL_SIZE) are rounded to a size class and recycled through a per thread cache backed by a central free list per class
+// the larger blocks go straight to the system allocator
+// every block is preceded by a 16 bytes header, so the returned pointers keep the 16 bytes alignment of the system allocator
+class SizeClassAllocator{
+	public:
+		static constexpr size_t MAX_SMALL_SIZE = 1024;
+		static constexpr size_t HEADER_SIZE = 16;
+		static constexpr uint32_t CLASS_COUNT = 20;
+
+		// the memory carved into small blocks, spans are kept until the process exits
+		static constexpr size_t SPAN_SIZE = 64 * 1024;
+
+		static void* malloc(size_t size);
+		static void* realloc(void* ptr, size_t newSize);
+		static void free(void* ptr);
+
+		// the usable size of the block, at least the requested size
+		static size_t getSize(void* ptr);
+		static size_t getRequestedSize(void* ptr);
+
+		// a 32 bits value stored in the block header, zero for new blocks and kept by realloc
+		static uint32_t getTag(void* ptr);
+		static void setTag(void* ptr, uint32_t tag);
+
+		// give the blocks cached by the calling thread back to the central lists, done automatically when a thread exits
+		static void flushThreadCache();
+
+		static uint32_t getSizeClass(size_t size);
+		static size_t getClassSize(uint32_t sizeClass);
+};
@@ -4,17 +4,45 @@
 
 class StackAllocator{
 	public:
+		// the top of the stack, to roll back every push made after it
+		using Marker = size_t;
+
 		StackAllocator(size_t size);
 		~StackAllocator();
 
 		void clear();
-		void* push(size_t size);
+
+		// return nullptr if the stack is full, alignment must be a power of two
+		void* push(size_t size, size_t alignment = 1);
+
+		template<typename T>
+		T* push(size_t count = 1){
+			return static_cast<T*>(push(sizeof(T) * count, alignof(T)));
+		}
+
 		size_t getCurrentUsedSize();
 		size_t getMaxSize();
 		void setCurrentUsedSize(size_t size);
 
+		Marker getMarker() const {return currentUsedSize;}
+		void rollback(Marker marker);
+
+		// restore the top of the stack when leaving the scope, everything pushed meanwhile is freed at once
+		class Scope{
+			public:
+				Scope(StackAllocator &allocator) : allocator{allocator}, marker{allocator.getMarker()}{}
+				~Scope(){allocator.rollback(marker);}
+
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+			private:
+				StackAllocator &allocator;
+				Marker marker;
+		};
+
 	private:
 		void* data;
 		size_t maxSize = 0;
 		size_t currentUsedSize = 0;
-};
\ No newline at end of file
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <iostream>
+#include <cstddef>
+
+// growable stack allocator backed by virtual memory
+// the whole range is reserved at construction, without physical memory, and the pages are committed as the top of the arena advances
+// the pointers stay valid until the arena is rolled back below them, the memory is never moved
+class VirtualArena{
+	public:
+		using Marker = size_t;
+
+		static constexpr size_t DEFAULT_COMMIT_SIZE = 64 * 1024;
+
+		// reserveSize is the maximal size of the arena, commitSize the minimal amount of memory committed at once
+		VirtualArena(size_t reserveSize, size_t commitSize = DEFAULT_COMMIT_SIZE);
+		~VirtualArena();
+
+		VirtualArena(const VirtualArena&) = delete;
+		VirtualArena& operator=(const VirtualArena&) = delete;
+
+		// return nullptr if the reserved range is full or the system cannot commit the memory, alignment must be a power of two
+		void* push(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template<typename T>
+		T* push(size_t count = 1){
+			return static_cast<T*>(push(sizeof(T) * count, alignof(T)));
+		}
+
+		// with decommit, the pages above the new top are given back to the system, otherwise they are kept for the next pushes
+		void clear(bool decommit = false);
+		void rollback(Marker marker, bool decommit = false);
+		Marker getMarker() const {return currentUsedSize;}
+
+		size_t getCurrentUsedSize() const {return currentUsedSize;}
+		size_t getCommittedSize() const {return committedSize;}
+		size_t getReservedSize() const {return reservedSize;}
+
+		// restore the top of the arena when leaving the scope
+		class Scope{
+			public:
+				Scope(VirtualArena &arena) : arena{arena}, marker{arena.getMarker()}{}
+				~Scope(){arena.rollback(marker);}
+
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+			private:
+				VirtualArena &arena;
+				Marker marker;
+		};
+
+	private:
+		bool commit(size_t size);
+		void decommit(size_t size);
+
+		char* data = nullptr;
+		size_t reservedSize = 0;
+		size_t committedSize = 0;
+		size_t currentUsedSize = 0;
+		size_t commitSize = 0;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <pthread.h>
+
+// watch a directory tree from a background thread, with inotify, only supported on linux
+// the changes of a file are debounced, the callback is called once the file did not change for debounceMilliseconds
+// the callback is called on the watcher thread, with the path of the file from the root as given, with '/' separators
+class FileWatcher{
+	public:
+		using Callback = void(*)(const char* path, void* userData);
+
+		// throw if the root cannot be watched
+		FileWatcher(const char* root, uint32_t debounceMilliseconds, Callback callback, void* userData);
+
+		// stop and join the watcher thread
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+	private:
+		static void* run(void* watcher);
+
+		void addDirectory(const std::string &path);
+		void readEvents();
+		void flush();
+
+		std::string root;
+		uint32_t debounceMilliseconds;
+		Callback callback;
+		void* userData;
+
+		int fd = -1;
+		pthread_t thread;
+		std::atomic<bool> running{true};
+
+		// only used by the watcher thread
+		std::unordered_map<int, std::string> directories; // watch descriptor to path
+		std::unordered_map<std::string, uint64_t> pending; // path to the time of the last change, in milliseconds
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+
+// asset pack, read only and memory mapped, built offline by tools/OdinPacker.cpp
+// layout : the header, the table of contents sorted by id, then the payloads, each aligned on the pack alignment
+// the integers are little endian
+
+struct PackHeader{
+	static constexpr uint32_t MAGIC = 0x4B50444F; // "ODPK"
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t alignment; // of the payloads, a power of two
+	uint64_t tocOffset;
+	uint64_t size; // of the whole pack
+};
+
+struct PackEntry{
+	uint64_t id; // Odin::hashName of the asset name
+	uint64_t type; // Odin::hashName of the file extension, without the dot
+	uint64_t offset; // from the start of the pack
+	uint64_t size;
+};
+
+static_assert(sizeof(PackHeader) == 32 && sizeof(PackEntry) == 32, "the pack layout must not depend on the compiler");
+
+class Pack{
+	public:
+		// map the whole file, throw if it is not a valid pack
+		Pack(const char* path);
+		~Pack();
+
+		Pack(const Pack&) = delete;
+		Pack& operator=(const Pack&) = delete;
+
+		// a binary search in the table of contents, nullptr if the pack does not contain the asset
+		const PackEntry* find(uint64_t id) const;
+
+		// the payload in the mapped file, valid as long as the pack
+		const void* getData(const PackEntry &entry) const {return data + entry.offset;}
+
+		uint32_t getEntryCount() const {return header().entryCount;}
+		const PackEntry* begin() const {return entries;}
+		const PackEntry* end() const {return entries + getEntryCount();}
+
+	private:
+		const PackHeader& header() const {return *reinterpret_cast<const PackHeader*>(data);}
+		void unmap();
+
+		const char* data = nullptr;
+		size_t size = 0;
+		const PackEntry* entries = nullptr;
+
+		#ifdef _WIN32
+			void* file = nullptr;
+			void* mapping = nullptr;
+		#endif
+};
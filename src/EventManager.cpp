@@ -24,6 +24,8 @@ namespace RainDrop{
 
 		Hermes::EventID keyPressed;
 		Hermes::EventID keyReleased;
+
+		bool replaying = false; // the replay callbacks are subscribed
 	};
 
 	STDEvents& getSTDEvents(){
@@ -289,22 +291,92 @@ namespace RainDrop{
 		instance.windowMinimized = Hermes::registerEvent("window minimized");
 		instance.windowMaximized = Hermes::registerEvent("window maximized");
 		instance.windowRestored = Hermes::registerEvent("window restored");
-		instance.windowMoved = Hermes::registerEvent("window moved", Hermes::DataLayout::construct<vec2<uint32_t>>());
-		instance.windowResized = Hermes::registerEvent("window resized", Hermes::DataLayout::construct<vec2<uint32_t>>());
+		// high frequency events only keep one slot per frame
+		instance.windowMoved = Hermes::registerEvent("window moved", Hermes::DataLayout::construct<vec2<uint32_t>>(), Hermes::Coalescing::KeepLast);
+		instance.windowResized = Hermes::registerEvent("window resized", Hermes::DataLayout::construct<vec2<uint32_t>>(), Hermes::Coalescing::KeepLast);
 
-		instance.mouseMoved = Hermes::registerEvent("mouse moved", Hermes::DataLayout::construct<vec2<float>>());
+		instance.mouseMoved = Hermes::registerEvent("mouse moved", Hermes::DataLayout::construct<vec2<float>>(), Hermes::Coalescing::KeepLast);
 		instance.mouseButtonDown = Hermes::registerEvent("mouse buttton down", Hermes::DataLayout::construct<MouseButton>());
 		instance.mouseButtonUp = Hermes::registerEvent("mouse button up", Hermes::DataLayout::construct<MouseButton>());
-		instance.mouseScrolled = Hermes::registerEvent("mouse scroled", Hermes::DataLayout::construct<vec2<float>>());
+		instance.mouseScrolled = Hermes::registerEvent("mouse scroled", Hermes::DataLayout::construct<vec2<float>>(), Hermes::Coalescing::Accumulate, &Hermes::accumulate<float>);
 
 		instance.keyPressed = Hermes::registerEvent("key pressed", Hermes::DataLayout::construct<Key, bool>());
 		instance.keyReleased = Hermes::registerEvent("key released", Hermes::DataLayout::construct<Key, bool>());
 	}
 
+	// while a journal is replayed, the input state is rebuilt from the replayed events instead of SDL
+	static bool onReplayMouseMoved(void* data){
+		getInstance().mousePos = *static_cast<vec2<float>*>(data);
+		return false;
+	}
+
+	static bool onReplayMouseButtonDown(void* data){
+		getInstance().buttonPressed[static_cast<int>(*static_cast<MouseButton*>(data))] = true;
+		return false;
+	}
+
+	static bool onReplayMouseButtonUp(void* data){
+		getInstance().buttonPressed[static_cast<int>(*static_cast<MouseButton*>(data))] = false;
+		return false;
+	}
+
+	static bool onReplayKeyPressed(void* data){
+		getInstance().keyPressed[static_cast<int>(*static_cast<Key*>(data))] = true;
+		return false;
+	}
+
+	static bool onReplayKeyReleased(void* data){
+		getInstance().keyPressed[static_cast<int>(*static_cast<Key*>(data))] = false;
+		return false;
+	}
+
+	void startReplay(const char* path){
+		STDEvents& instance = getSTDEvents();
+		stopReplay();
+		Hermes::startReplay(path);
+
+		instance.replaying = true;
+		Hermes::subscribe(instance.mouseMoved, &onReplayMouseMoved);
+		Hermes::subscribe(instance.mouseButtonDown, &onReplayMouseButtonDown);
+		Hermes::subscribe(instance.mouseButtonUp, &onReplayMouseButtonUp);
+		Hermes::subscribe(instance.keyPressed, &onReplayKeyPressed);
+		Hermes::subscribe(instance.keyReleased, &onReplayKeyReleased);
+	}
+
+	void stopReplay(){
+		STDEvents& instance = getSTDEvents();
+		Hermes::stopReplay();
+
+		if (!instance.replaying) return;
+		instance.replaying = false;
+		Hermes::unsubscribe(instance.mouseMoved, &onReplayMouseMoved);
+		Hermes::unsubscribe(instance.mouseButtonDown, &onReplayMouseButtonDown);
+		Hermes::unsubscribe(instance.mouseButtonUp, &onReplayMouseButtonUp);
+		Hermes::unsubscribe(instance.keyPressed, &onReplayKeyPressed);
+		Hermes::unsubscribe(instance.keyReleased, &onReplayKeyReleased);
+	}
+
 	void poolEvents(){
 		STDEvents& instance = getSTDEvents();
-		
 		SDL_Event e;
+
+		// the journal ended during the last update, back to the live input
+		if (instance.replaying && !Hermes::isReplaying()) stopReplay();
+
+		// the live input is suppressed during a replay, the window can still be closed and resized
+		if (Hermes::isReplaying()){
+			while (SDL_PollEvent(&e)){
+				if (e.type == SDL_QUIT){
+					Hermes::triggerEvent(instance.windowClosed);
+				} else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_RESIZED){
+					FoveaOnWindowResized(static_cast<uint32_t>(e.window.data1), static_cast<uint32_t>(e.window.data2));
+				}
+			}
+			return;
+		}
+
+		// every SDL event is an external trigger, the ones injected back by a replay
+		Hermes::beginExternal();
 		while (SDL_PollEvent(&e)){
 			switch (e.type){
 				case SDL_QUIT:{
@@ -385,6 +457,7 @@ namespace RainDrop{
 
 			}
 		}
+		Hermes::endExternal();
 	}
 
 }
\ No newline at end of file
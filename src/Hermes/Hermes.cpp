@@ -2,7 +2,11 @@
 #include "horreum/Horreum.hpp"
 #include <cassert>
 #include <cstring>
+#include <new>
+#include <utility>
 
+// set while a worker task runs parallel callbacks, their triggers are queued apart and never coalesced
+static thread_local bool inParallelTask = false;
 
 Hermes& Hermes::getInstance(){
 	static Hermes instance;
@@ -11,33 +15,53 @@ Hermes& Hermes::getInstance(){
 
 void Hermes::initialize(uint16_t eventTypeCount, uint32_t bufferSize){
 	Hermes &instance = getInstance();
+	Horreum::CategoryScope category(Horreum::Category::Events);
 	instance.maxAvailableEventTypeCount = eventTypeCount;
 	instance.events = static_cast<EventType*>(HRM_MALLOC(sizeof(EventType) * eventTypeCount));
 
 	for (int i=0; i<eventTypeCount; i++){
-		instance.events[i].callbacks = new std::list<EventCallback>();
-		
+		new (&instance.events[i]) EventType();
+		instance.events[i].callbacks = new std::pmr::list<EventCallback>(&instance.resource);
+		instance.events[i].batchCallbacks = new std::pmr::list<EventBatchCallback>(&instance.resource);
 	}
 
-	instance.dataBuffer = new StackAllocator(bufferSize);
+	instance.batchQueue = static_cast<EventID*>(HRM_MALLOC(sizeof(EventID) * eventTypeCount));
+	instance.dispatchQueue = static_cast<EventID*>(HRM_MALLOC(sizeof(EventID) * eventTypeCount));
+	instance.parallelQueue = static_cast<EventID*>(HRM_MALLOC(sizeof(EventID) * eventTypeCount));
+	pthread_mutex_init(&instance.queueMutex, nullptr);
+
+	instance.dataBuffer = new FrameAllocator(bufferSize, PAYLOAD_FRAME_COUNT);
 }
 
 Hermes::~Hermes(){
-	#ifndef NDEBUG
-		for (int i=0; i<registeredEventCount; i++){
-			HRM_FREE(events[i].name);
-		}
-	#endif
+	setStatsDump(nullptr);
 
 	for (int i=0; i<maxAvailableEventTypeCount; i++){
 		delete events[i].callbacks;
+		delete events[i].batchCallbacks;
+		HRM_FREE(events[i].batchData);
+		HRM_FREE(events[i].dispatchData);
+		HRM_FREE(events[i].parallelData);
+	}
+
+	for (uint32_t i=0; i<timerCount; i++){
+		HRM_FREE(timers[i].payload);
 	}
 
+	stopRecording();
+	stopReplay();
+
 	HRM_FREE(events);
+	HRM_FREE(batchQueue);
+	HRM_FREE(dispatchQueue);
+	HRM_FREE(parallelQueue);
+	pthread_mutex_destroy(&queueMutex);
+	HRM_FREE(timers);
+	HRM_FREE(coalesceBuffer);
 	delete dataBuffer;
 }
 
-Hermes::EventID Hermes::registerEvent(const char* name, uint16_t dataSize){
+Hermes::EventID Hermes::registerEvent(const char* name, uint16_t dataSize, Coalescing coalescing, AccumulateFn accumulateFn, Delivery delivery){
 	Hermes& instance = getInstance();
 	HERMES_ASSERT(instance.registeredEventCount <= instance.maxAvailableEventTypeCount && "event type overflow");
 
@@ -53,32 +77,141 @@ Hermes::EventID Hermes::registerEvent(const char* name, uint16_t dataSize){
 
 	// create the evnt type from the given informations
 	EventType &event = instance.events[registeredEventCount];
-	// #ifndef NDEBUG
-	// 	event.name = static_cast<char*>(HRM_MALLOC(sizeof(char) * strlen(name)));
-	// 	strcpy(event.name, name);
-	// #endif
 	event.id = registeredEventCount;
 	event.dataSize = dataSize;
+	event.coalescing = coalescing;
+	event.accumulateFn = accumulateFn;
+	event.pendingCall = nullptr;
+	event.delivery = delivery;
+
+	HERMES_ASSERT((coalescing != Coalescing::Accumulate || accumulateFn) && "accumulated events require an accumulate function");
+	HERMES_ASSERT((delivery != Delivery::Immediate || coalescing == Coalescing::KeepAll) && "immediate events cannot be coalesced");
+
+	// the scratch payload used to merge accumulated events must fit the largest of them
+	if (coalescing == Coalescing::Accumulate && dataSize > instance.coalesceBufferSize){
+		Horreum::CategoryScope category(Horreum::Category::Events);
+		instance.coalesceBuffer = HRM_REALLOC(instance.coalesceBuffer, dataSize);
+		instance.coalesceBufferSize = dataSize;
+	}
 
 	EventID id = registeredEventCount;
 	registeredEventCount++;
 
-	instance.eventMap[name] = id;
+	// the map nodes are stable, the event keep a pointer to its key as name
+	event.name = instance.eventMap.emplace(name, id).first->first.c_str();
+
+	if (instance.journal){
+		recordEventType(id, name);
+	}
 	return id;
 }
 
-Hermes::EventID Hermes::registerEvent(const char* name, DataLayout data){
-	return registerEvent(name, data.size);
+Hermes::EventID Hermes::registerEvent(const char* name, DataLayout data, Coalescing coalescing, AccumulateFn accumulateFn, Delivery delivery){
+	return registerEvent(name, data.size, coalescing, accumulateFn, delivery);
+}
+
+Hermes::EventID Hermes::registerEvent(const char* name, uint16_t dataSize, Delivery delivery){
+	return registerEvent(name, dataSize, Coalescing::KeepAll, nullptr, delivery);
+}
+
+void Hermes::setWorkerPool(WorkerPool* pool){
+	getInstance().workers = pool;
+}
+
+void Hermes::lockQueue(){
+	Hermes& instance = getInstance();
+	if (instance.parallelInFlight) pthread_mutex_lock(&instance.queueMutex);
+}
+
+void Hermes::unlockQueue(){
+	Hermes& instance = getInstance();
+	if (instance.parallelInFlight) pthread_mutex_unlock(&instance.queueMutex);
+}
+
+void* Hermes::getPayloadSlot(EventType& event){
+	Hermes& instance = getInstance();
+	if (event.pendingCall && !inParallelTask){
+		if (event.coalescing == Coalescing::KeepLast) return event.pendingCall->data;
+		return instance.coalesceBuffer;
+	}
+
+	// the frame allocator is lock free, the parallel callbacks can push their payloads directly
+	void* data = instance.dataBuffer->push(event.dataSize, PAYLOAD_ALIGNMENT);
+	HERMES_ASSERT((data || event.dataSize == 0) && "event data buffer overflow");
+	return data;
 }
 
 void Hermes::_triggerEvent(EventID eventID, void* data){
 	Hermes& instance = getInstance();
 	HERMES_ASSERT(eventID < instance.registeredEventCount && "event type overflow");
+	EventType& event = instance.events[eventID];
+
+	lockQueue();
+
+	if (instance.journal){
+		recordTrigger(eventID, data);
+	}
+
+	#ifdef HERMES_PROFILE
+		event.frameStats.triggers++;
+		event.frameStats.payloadBytes += event.dataSize;
+	#endif
+
+	if (event.delivery == Delivery::Immediate){
+		if (!event.batchCallbacks->empty()){
+			gatherBatch(event, data);
+		}
+		unlockQueue();
+
+		dispatchCallbacks(event, data);
+		return;
+	}
+
 	EventCall call;
 	call.id = eventID;
 	call.data = data;
 
-	instance.calls.push_back(call);
+	// the queued slots belong to the main thread, the parallel callbacks triggers are moved to the queue after the barrier
+	if (inParallelTask){
+		instance.workerCalls.push_back(call);
+		unlockQueue();
+		return;
+	}
+
+	if (coalesce(event, data)){
+		#ifdef HERMES_PROFILE
+			event.frameStats.coalesced++;
+		#endif
+		unlockQueue();
+		return;
+	}
+
+	std::pmr::list<EventCall> &queue = event.delivery == Delivery::Parallel ? instance.parallelCalls : instance.calls;
+	queue.push_back(call);
+
+	if (event.coalescing != Coalescing::KeepAll){
+		event.pendingCall = &queue.back();
+	}
+
+	unlockQueue();
+}
+
+bool Hermes::coalesce(EventType& event, void* data){
+	if (!event.pendingCall) return false;
+
+	switch (event.coalescing){
+		case Coalescing::KeepAll: return false;
+		case Coalescing::KeepLast:{
+			// the payload may have been written in place (see getPayloadSlot) or allocated by the caller
+			event.pendingCall->data = data;
+			return true;
+		}
+		case Coalescing::Accumulate:{
+			event.accumulateFn(event.pendingCall->data, data, event.dataSize);
+			return true;
+		}
+	}
+	return false;
 }
 
 bool Hermes::callCallback(EventCallback &callback, void* data){
@@ -92,13 +225,11 @@ bool Hermes::callCallback(EventCallback &callback, void* data){
 void Hermes::printEvents(){
 	Hermes& instance = getInstance();
 
-	#ifndef NDEBUG
 	for (int i=0; i<instance.registeredEventCount; i++){
 		auto &event = instance.events[i];
 
 		printf("name : %s, id : %d, size : %d\n", event.name, i, event.dataSize);
 	}
-	#endif
 }
 
 Hermes::EventID Hermes::getEventIndex(const char* name){
@@ -108,18 +239,194 @@ Hermes::EventID Hermes::getEventIndex(const char* name){
 	return iterator->second;
 }
 
+void Hermes::dispatchCallbacks(EventType& event, void* data){
+	for (auto &callback : *event.callbacks){
+		#ifdef HERMES_PROFILE
+			uint64_t start = profileNow();
+			bool handled = callCallback(callback, data);
+			profileCallback(callback.stats, event.frameStats, profileNow() - start);
+			if (handled) break;
+		#else
+			if (callCallback(callback, data)) break;
+		#endif
+	}
+}
+
+void Hermes::dispatch(EventCall &call){
+	EventType& event = getInstance().events[call.id];
+
+	// triggers made from the callbacks will be queued in a new slot
+	event.pendingCall = nullptr;
+
+	if (!event.batchCallbacks->empty()){
+		lockQueue();
+		gatherBatch(event, call.data);
+		unlockQueue();
+	}
+
+	dispatchCallbacks(event, call.data);
+}
+
+void Hermes::launchParallel(){
+	Hermes &instance = getInstance();
+	if (instance.parallelCalls.empty()) return;
+
+	// group the payloads by event type, each type is handed to one task so its calls keep their order
+	for (auto &call : instance.parallelCalls){
+		EventType& event = instance.events[call.id];
+		event.pendingCall = nullptr;
+
+		if (!event.batchCallbacks->empty()){
+			gatherBatch(event, call.data);
+		}
+
+		if (event.parallelCount == 0){
+			instance.parallelQueue[instance.parallelQueueSize++] = event.id;
+		}
+
+		if (event.parallelCount == event.parallelCapacity){
+			Horreum::CategoryScope category(Horreum::Category::Events);
+			event.parallelCapacity = event.parallelCapacity == 0 ? 16 : event.parallelCapacity * 2;
+			event.parallelData = static_cast<void**>(HRM_REALLOC(event.parallelData, sizeof(void*) * event.parallelCapacity));
+		}
+		event.parallelData[event.parallelCount++] = call.data;
+	}
+	instance.parallelCalls.clear();
+
+	instance.parallelInFlight = instance.workers != nullptr;
+
+	for (EventID i=0; i<instance.parallelQueueSize; i++){
+		EventType* event = &instance.events[instance.parallelQueue[i]];
+
+		if (instance.workers){
+			instance.workers->submit(&Hermes::runParallel, event, &instance.parallelGroup);
+		} else {
+			runParallel(event);
+		}
+	}
+}
+
+void Hermes::runParallel(void* data){
+	EventType& event = *static_cast<EventType*>(data);
+
+	inParallelTask = true;
+	for (uint32_t i=0; i<event.parallelCount; i++){
+		dispatchCallbacks(event, event.parallelData[i]);
+	}
+	inParallelTask = false;
+}
+
+void Hermes::waitParallel(){
+	Hermes &instance = getInstance();
+	if (instance.parallelQueueSize == 0) return;
+
+	if (instance.workers){
+		instance.workers->wait(instance.parallelGroup);
+	}
+	instance.parallelInFlight = false;
+
+	for (EventID i=0; i<instance.parallelQueueSize; i++){
+		instance.events[instance.parallelQueue[i]].parallelCount = 0;
+	}
+	instance.parallelQueueSize = 0;
+
+	instance.calls.splice(instance.calls.end(), instance.workerCalls);
+}
+
+void Hermes::gatherBatch(EventType& event, void* data){
+	Hermes &instance = getInstance();
+
+	if (event.batchCount == 0){
+		instance.batchQueue[instance.batchQueueSize++] = event.id;
+	}
+
+	if (event.dataSize != 0){
+		// the buffer is kept between frames, it only grows until it fits the biggest frame
+		if (event.batchCount == event.batchCapacity){
+			Horreum::CategoryScope category(Horreum::Category::Events);
+			event.batchCapacity = event.batchCapacity == 0 ? 16 : event.batchCapacity * 2;
+			event.batchData = static_cast<char*>(HRM_REALLOC(event.batchData, static_cast<size_t>(event.batchCapacity) * event.dataSize));
+		}
+		memcpy(event.batchData + static_cast<size_t>(event.batchCount) * event.dataSize, data, event.dataSize);
+	}
+
+	event.batchCount++;
+}
+
+void Hermes::dispatchBatches(){
+	Hermes &instance = getInstance();
+
+	// the queue and the payloads are swapped out first, the events triggered by the callbacks are gathered for the next dispatch
+	EventID queueSize = instance.batchQueueSize;
+	std::swap(instance.batchQueue, instance.dispatchQueue);
+	instance.batchQueueSize = 0;
+
+	for (EventID i=0; i<queueSize; i++){
+		EventType& event = instance.events[instance.dispatchQueue[i]];
+		std::swap(event.batchData, event.dispatchData);
+		std::swap(event.batchCapacity, event.dispatchCapacity);
+		event.dispatchCount = event.batchCount;
+		event.batchCount = 0;
+	}
+
+	for (EventID i=0; i<queueSize; i++){
+		EventType& event = instance.events[instance.dispatchQueue[i]];
+
+		for (auto &callback : *event.batchCallbacks){
+			#ifdef HERMES_PROFILE
+				uint64_t start = profileNow();
+			#endif
+
+			switch (callback.type){
+				case EventCallback::Function: callback.callback.function(event.dispatchData, event.dispatchCount); break;
+				case EventCallback::Method: callback.callback.method(callback.subscribedInstance, event.dispatchData, event.dispatchCount); break;
+			}
+
+			#ifdef HERMES_PROFILE
+				profileCallback(callback.stats, event.frameStats, profileNow() - start);
+			#endif
+		}
+	}
+}
+
 void Hermes::update(){
 	Hermes &instance = getInstance();
-	for (auto &c : instance.calls){
-		EventType& event = instance.events[c.id];
-		
-		for (auto &callback : *event.callbacks){
-			if (callCallback(callback, c.data)) break;
+
+	// close the journal frame of the triggers made since the last update, then inject the replayed ones
+	if (instance.journal) recordFrame();
+	if (instance.replay && !instance.replayEnded) replayFrame();
+
+	// the expired timers are queued before the dispatch, so they are delivered this frame
+	updateTimers();
+
+	while (true){
+		// the parallel events are handed to the workers first, they run while the deferred ones are dispatched here
+		launchParallel();
+
+		while (!instance.calls.empty()){
+			EventCall &call = instance.calls.front();
+
+			// queued by a parallel callback, it waits for the next launch
+			if (instance.events[call.id].delivery == Delivery::Parallel){
+				instance.parallelCalls.splice(instance.parallelCalls.end(), instance.calls, instance.calls.begin());
+				continue;
+			}
+
+			dispatch(call);
+			instance.calls.pop_front();
 		}
+
+		waitParallel();
+		if (!instance.calls.empty() || !instance.parallelCalls.empty()) continue;
+
+		// once every queued call has been handled, deliver the batches, they may queue new calls
+		dispatchBatches();
+		if (instance.calls.empty() && instance.parallelCalls.empty()) break;
 	}
 
-	instance.calls.clear();
-	instance.dataBuffer->clear();
+	instance.dataBuffer->beginFrame();
+
+	endFrameStats();
 }
 
 void Hermes::subscribe(const char *name, EventFn callback){subscribe(getInstance().getEventIndex(name), callback);}
@@ -161,8 +468,7 @@ void Hermes::unsubscribe(EventID id, EventFn callback){
 
 	EventType& event = instance.events[id];
 	
-	auto it = event.callbacks->begin();
-	while (it != event.callbacks->end()){
+	for (auto it = event.callbacks->begin(); it != event.callbacks->end(); it++){
 		if (it->callback.function == callback){
 			event.callbacks->erase(it);
 			break;
@@ -175,8 +481,7 @@ void Hermes::unsubscribe(EventID id, EventMt callback){
 
 	EventType& event = instance.events[id];
 	
-	auto it = event.callbacks->begin();
-	while (it != event.callbacks->end()){
+	for (auto it = event.callbacks->begin(); it != event.callbacks->end(); it++){
 		if (it->callback.method == callback){
 			event.callbacks->erase(it);
 			break;
@@ -185,6 +490,62 @@ void Hermes::unsubscribe(EventID id, EventMt callback){
 }
 
 
+void Hermes::subscribeBatch(const char *name, BatchFn callback){subscribeBatch(getEventIndex(name), callback);}
+void Hermes::subscribeBatch(const char *name, void* subscribedInstance, BatchMt callback){subscribeBatch(getEventIndex(name), subscribedInstance, callback);}
+
+void Hermes::subscribeBatch(EventID id, BatchFn callback){
+	Hermes &instance = getInstance();
+	HERMES_ASSERT(instance.registeredEventCount > id && "event type overflow");
+
+	EventType& event = instance.events[id];
+	EventBatchCallback cb;
+	cb.callback.function = callback;
+	cb.type = EventCallback::Function;
+	event.batchCallbacks->push_back(cb);
+}
+
+void Hermes::subscribeBatch(EventID id, void* subscribedInstance, BatchMt callback){
+	Hermes &instance = getInstance();
+	HERMES_ASSERT(instance.registeredEventCount > id && "event type overflow");
+
+	EventType& event = instance.events[id];
+	EventBatchCallback cb;
+	cb.callback.method = callback;
+	cb.subscribedInstance = subscribedInstance;
+	cb.type = EventCallback::Method;
+	event.batchCallbacks->push_back(cb);
+}
+
+void Hermes::unsubscribeBatch(const char *name, BatchFn callback){
+	unsubscribeBatch(getEventIndex(name), callback);
+}
+
+void Hermes::unsubscribeBatch(const char *name, BatchMt callback){
+	unsubscribeBatch(getEventIndex(name), callback);
+}
+
+void Hermes::unsubscribeBatch(EventID id, BatchFn callback){
+	EventType& event = getInstance().events[id];
+
+	for (auto it = event.batchCallbacks->begin(); it != event.batchCallbacks->end(); it++){
+		if (it->type == EventCallback::Function && it->callback.function == callback){
+			event.batchCallbacks->erase(it);
+			break;
+		}
+	}
+}
+
+void Hermes::unsubscribeBatch(EventID id, BatchMt callback){
+	EventType& event = getInstance().events[id];
+
+	for (auto it = event.batchCallbacks->begin(); it != event.batchCallbacks->end(); it++){
+		if (it->type == EventCallback::Method && it->callback.method == callback){
+			event.batchCallbacks->erase(it);
+			break;
+		}
+	}
+}
+
 Hermes::EventID Hermes::getRegisteredEventCount(){
 	return getInstance().registeredEventCount;
 }
@@ -0,0 +1,256 @@
+#include "hermes/Journal.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstring>
+
+// ====================================== writer
+
+JournalWriter::JournalWriter(const char* path){
+	file = fopen(path, "wb");
+	if (!file) throw "failed to open the journal file";
+
+	for (uint32_t i=0; i<CHUNK_COUNT; i++){
+		chunks[i].data = static_cast<char*>(HRM_MALLOC(CHUNK_SIZE));
+		chunks[i].next = i + 1 < CHUNK_COUNT ? &chunks[i + 1] : nullptr;
+	}
+
+	current = &chunks[0];
+	freeChunks = &chunks[1];
+	current->next = nullptr;
+
+	pthread_mutex_init(&mutex, nullptr);
+	pthread_cond_init(&condition, nullptr);
+	pthread_create(&thread, nullptr, &JournalWriter::writerThread, this);
+}
+
+JournalWriter::~JournalWriter(){
+	flush();
+
+	pthread_mutex_lock(&mutex);
+	running = false;
+	pthread_cond_signal(&condition);
+	pthread_mutex_unlock(&mutex);
+	pthread_join(thread, nullptr);
+
+	// every chunk is written, the frame markers still waiting end the file
+	for (; pendingFrames != 0; pendingFrames--){
+		fwrite(&JOURNAL_FRAME_MARKER, sizeof(uint16_t), 1, file);
+	}
+
+	pthread_cond_destroy(&condition);
+	pthread_mutex_destroy(&mutex);
+	fclose(file);
+
+	for (uint32_t i=0; i<CHUNK_COUNT; i++){
+		HRM_FREE(chunks[i].data);
+	}
+
+	if (droppedRecords != 0){
+		fprintf(stderr, "event journal : %llu records dropped, the writer could not keep up\n", static_cast<unsigned long long>(droppedRecords));
+	}
+}
+
+bool JournalWriter::fit(size_t size){
+	assert(size <= CHUNK_SIZE && "journal write larger than a chunk");
+	if (!writePendingFrames()) return false;
+	return (current && current->size + size <= CHUNK_SIZE) || acquireChunk();
+}
+
+bool JournalWriter::writePendingFrames(){
+	while (pendingFrames != 0){
+		if (!current || current->size + sizeof(uint16_t) > CHUNK_SIZE){
+			if (!acquireChunk()) return false;
+		}
+
+		memcpy(current->data + current->size, &JOURNAL_FRAME_MARKER, sizeof(uint16_t));
+		current->size += sizeof(uint16_t);
+		pendingFrames--;
+	}
+	return true;
+}
+
+bool JournalWriter::reserve(size_t size){
+	if (fit(size)) return true;
+	droppedRecords++;
+	return false;
+}
+
+void JournalWriter::write(const void* data, size_t size){
+	if (!fit(size)){
+		droppedRecords++;
+		return;
+	}
+
+	memcpy(current->data + current->size, data, size);
+	current->size += size;
+}
+
+void JournalWriter::writeRecord(uint16_t id, const void* payload, uint16_t size){
+	size_t recordSize = sizeof(uint16_t) + size;
+	if (!fit(recordSize)){
+		droppedRecords++;
+		return;
+	}
+
+	memcpy(current->data + current->size, &id, sizeof(uint16_t));
+	if (size != 0) memcpy(current->data + current->size + sizeof(uint16_t), payload, size);
+	current->size += recordSize;
+}
+
+void JournalWriter::writeFrame(){
+	// the triggers of the frames without chunk are dropped, their markers are kept so the replay stays frame exact
+	pendingFrames++;
+	writePendingFrames();
+}
+
+bool JournalWriter::acquireChunk(){
+	pthread_mutex_lock(&mutex);
+
+	// hand the filled chunk to the writer thread
+	if (current && current->size != 0){
+		current->next = nullptr;
+		if (lastFullChunk){
+			lastFullChunk->next = current;
+		} else {
+			fullChunks = current;
+		}
+		lastFullChunk = current;
+		current = nullptr;
+		pthread_cond_signal(&condition);
+	}
+
+	// never wait for the writer, the caller is the frame
+	if (!current && freeChunks){
+		current = freeChunks;
+		freeChunks = freeChunks->next;
+		current->next = nullptr;
+		current->size = 0;
+	}
+
+	pthread_mutex_unlock(&mutex);
+	return current != nullptr;
+}
+
+void JournalWriter::flush(){
+	if (current && current->size != 0){
+		acquireChunk();
+	}
+}
+
+void* JournalWriter::writerThread(void* ptr){
+	JournalWriter* writer = static_cast<JournalWriter*>(ptr);
+
+	pthread_mutex_lock(&writer->mutex);
+	while (true){
+		while (writer->running && !writer->fullChunks){
+			pthread_cond_wait(&writer->condition, &writer->mutex);
+		}
+
+		Chunk* chunk = writer->fullChunks;
+		if (!chunk){
+			if (!writer->running) break;
+			continue;
+		}
+
+		writer->fullChunks = chunk->next;
+		if (!writer->fullChunks) writer->lastFullChunk = nullptr;
+
+		// the file is written outside of the lock
+		pthread_mutex_unlock(&writer->mutex);
+		fwrite(chunk->data, 1, chunk->size, writer->file);
+		pthread_mutex_lock(&writer->mutex);
+
+		chunk->size = 0;
+		chunk->next = writer->freeChunks;
+		writer->freeChunks = chunk;
+	}
+	pthread_mutex_unlock(&writer->mutex);
+
+	fflush(writer->file);
+	return nullptr;
+}
+
+// ====================================== reader
+
+JournalReader::JournalReader(const char* path){
+	file = fopen(path, "rb");
+	if (!file) throw "failed to open the journal file";
+
+	char magic[4];
+	uint16_t version;
+	if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "HRMJ", 4) != 0){
+		fclose(file);
+		throw "invalid journal file";
+	}
+
+	if (fread(&version, sizeof(uint16_t), 1, file) != 1 || version != JOURNAL_VERSION){
+		fclose(file);
+		throw "unsupported journal version";
+	}
+
+	if (fread(&eventCount, sizeof(uint16_t), 1, file) != 1){
+		fclose(file);
+		throw "invalid journal file";
+	}
+
+	events = static_cast<EventInfo*>(HRM_MALLOC(sizeof(EventInfo) * eventCount));
+	for (uint16_t i=0; i<eventCount; i++){
+		if (!readEventInfo(events[i])){
+			eventCount = i + 1;
+			close();
+			throw "invalid journal file";
+		}
+	}
+}
+
+bool JournalReader::readEventInfo(EventInfo &event){
+	uint16_t nameLength = 0;
+	event.name = nullptr;
+
+	bool valid = fread(&event.id, sizeof(uint16_t), 1, file) == 1;
+	valid = valid && fread(&event.dataSize, sizeof(uint16_t), 1, file) == 1;
+	valid = valid && fread(&nameLength, sizeof(uint16_t), 1, file) == 1;
+	if (!valid) return false;
+
+	event.name = static_cast<char*>(HRM_MALLOC(nameLength + 1));
+	event.name[nameLength] = '\0';
+	return fread(event.name, 1, nameLength, file) == nameLength;
+}
+
+bool JournalReader::readEvent(){
+	events = static_cast<EventInfo*>(HRM_REALLOC(events, sizeof(EventInfo) * (eventCount + 1)));
+	eventCount++;
+	return readEventInfo(events[eventCount - 1]);
+}
+
+JournalReader::~JournalReader(){
+	close();
+}
+
+void JournalReader::close(){
+	for (uint16_t i=0; i<eventCount; i++){
+		HRM_FREE(events[i].name);
+	}
+	HRM_FREE(events);
+	events = nullptr;
+	eventCount = 0;
+
+	if (file) fclose(file);
+	file = nullptr;
+}
+
+bool JournalReader::readID(uint16_t &id){
+	return fread(&id, sizeof(uint16_t), 1, file) == 1;
+}
+
+bool JournalReader::isAtEnd(){
+	int c = fgetc(file);
+	if (c == EOF) return true;
+	ungetc(c, file);
+	return false;
+}
+
+bool JournalReader::readPayload(void* data, uint16_t size){
+	if (size == 0) return true;
+	return fread(data, 1, size, file) == size;
+}
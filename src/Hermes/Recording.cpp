@@ -0,0 +1,214 @@
+#include "Hermes.hpp"
+#include "hermes/Journal.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstring>
+
+static constexpr Hermes::EventID INVALID_EVENT = UINT16_MAX;
+
+void Hermes::startRecording(const char* path){
+	Hermes &instance = getInstance();
+	stopRecording();
+
+	Horreum::CategoryScope category(Horreum::Category::Events);
+	instance.journal = new JournalWriter(path);
+
+	uint16_t version = JOURNAL_VERSION;
+	uint16_t eventCount = instance.registeredEventCount;
+	instance.journal->reserve(4 + 2 * sizeof(uint16_t));
+	instance.journal->write("HRMJ", 4);
+	instance.journal->write(&version, sizeof(uint16_t));
+	instance.journal->write(&eventCount, sizeof(uint16_t));
+
+	for (auto &it : instance.eventMap){
+		EventID id = it.second;
+		uint16_t dataSize = instance.events[id].dataSize;
+		uint16_t nameLength = static_cast<uint16_t>(it.first.size());
+
+		if (!instance.journal->reserve(3 * sizeof(uint16_t) + nameLength)) continue;
+		instance.journal->write(&id, sizeof(uint16_t));
+		instance.journal->write(&dataSize, sizeof(uint16_t));
+		instance.journal->write(&nameLength, sizeof(uint16_t));
+		instance.journal->write(it.first.c_str(), nameLength);
+	}
+}
+
+void Hermes::stopRecording(){
+	Hermes &instance = getInstance();
+
+	if (!instance.journal) return;
+	instance.droppedRecords = instance.journal->getDroppedRecordCount();
+
+	// the writer flush the pending chunks and join its thread
+	delete instance.journal;
+	instance.journal = nullptr;
+}
+
+bool Hermes::isRecording(){
+	return getInstance().journal != nullptr;
+}
+
+uint64_t Hermes::getDroppedRecordCount(){
+	Hermes &instance = getInstance();
+	return instance.journal ? instance.journal->getDroppedRecordCount() : instance.droppedRecords;
+}
+
+void Hermes::recordEventType(EventID id, const char* name){
+	Hermes &instance = getInstance();
+
+	uint16_t marker = JOURNAL_REGISTER_MARKER;
+	uint16_t dataSize = instance.events[id].dataSize;
+	uint16_t nameLength = static_cast<uint16_t>(strlen(name));
+
+	// written whole or dropped, a partial description would desync the reader
+	if (!instance.journal->reserve(4 * sizeof(uint16_t) + nameLength)) return;
+	instance.journal->write(&marker, sizeof(uint16_t));
+	instance.journal->write(&id, sizeof(uint16_t));
+	instance.journal->write(&dataSize, sizeof(uint16_t));
+	instance.journal->write(&nameLength, sizeof(uint16_t));
+	instance.journal->write(name, nameLength);
+}
+
+void Hermes::recordTrigger(EventID id, void* data){
+	Hermes &instance = getInstance();
+	HERMES_ASSERT(id < JOURNAL_EXTERNAL_BIT && "event id cannot be journaled");
+
+	uint16_t record = instance.external ? (id | JOURNAL_EXTERNAL_BIT) : id;
+	instance.journal->writeRecord(record, data, instance.events[id].dataSize);
+}
+
+void Hermes::recordFrame(){
+	getInstance().journal->writeFrame();
+}
+
+void Hermes::startReplay(const char* path){
+	Hermes &instance = getInstance();
+	stopReplay();
+
+	Horreum::CategoryScope category(Horreum::Category::Events);
+	instance.replay = new JournalReader(path);
+	instance.replayEnded = false;
+
+	// map the journal events to the registered ones by name, the layout has to match
+	uint16_t maxID = 0;
+	for (uint16_t i=0; i<instance.replay->getEventCount(); i++){
+		uint16_t id = instance.replay->getEvent(i).id;
+		if (id >= maxID) maxID = id + 1;
+	}
+
+	instance.replayMap = static_cast<EventID*>(HRM_MALLOC(sizeof(EventID) * maxID));
+	instance.replayMapSize = maxID;
+	for (uint16_t i=0; i<maxID; i++){
+		instance.replayMap[i] = INVALID_EVENT;
+	}
+
+	for (uint16_t i=0; i<instance.replay->getEventCount(); i++){
+		auto &info = instance.replay->getEvent(i);
+		auto it = instance.eventMap.find(info.name);
+		if (it == instance.eventMap.end()) continue;
+
+		if (instance.events[it->second].dataSize != info.dataSize){
+			stopReplay();
+			throw "the journal event layout does not match the registered event";
+		}
+		instance.replayMap[info.id] = it->second;
+	}
+}
+
+void Hermes::stopReplay(){
+	Hermes &instance = getInstance();
+
+	delete instance.replay;
+	instance.replay = nullptr;
+
+	HRM_FREE(instance.replayMap);
+	instance.replayMap = nullptr;
+	instance.replayMapSize = 0;
+}
+
+bool Hermes::isReplaying(){
+	Hermes &instance = getInstance();
+	return instance.replay && !instance.replayEnded;
+}
+
+void Hermes::replayFrame(){
+	Hermes &instance = getInstance();
+	JournalReader &reader = *instance.replay;
+
+	uint16_t record;
+	while (reader.readID(record)){
+		if (record == JOURNAL_FRAME_MARKER){
+			if (reader.isAtEnd()) break;
+			return;
+		}
+
+		// an event registered while recording, extend the mapping
+		if (record == JOURNAL_REGISTER_MARKER){
+			Horreum::CategoryScope category(Horreum::Category::Events);
+			if (!reader.readEvent()) break;
+			auto &info = reader.getEvent(reader.getEventCount() - 1);
+
+			if (info.id >= instance.replayMapSize){
+				instance.replayMap = static_cast<EventID*>(HRM_REALLOC(instance.replayMap, sizeof(EventID) * (info.id + 1)));
+				for (uint16_t i=instance.replayMapSize; i<=info.id; i++){
+					instance.replayMap[i] = INVALID_EVENT;
+				}
+				instance.replayMapSize = info.id + 1;
+			}
+
+			auto it = instance.eventMap.find(info.name);
+			bool match = it != instance.eventMap.end() && instance.events[it->second].dataSize == info.dataSize;
+			instance.replayMap[info.id] = match ? it->second : INVALID_EVENT;
+			continue;
+		}
+
+		bool external = record & JOURNAL_EXTERNAL_BIT;
+		uint16_t recordedID = record & ~JOURNAL_EXTERNAL_BIT;
+		if (recordedID >= instance.replayMapSize) break;
+
+		EventID id = instance.replayMap[recordedID];
+		uint16_t dataSize = 0;
+		if (id != INVALID_EVENT){
+			dataSize = instance.events[id].dataSize;
+		} else {
+			// unknown event, its payload is skipped using the recorded layout
+			for (uint16_t i=0; i<reader.getEventCount(); i++){
+				if (reader.getEvent(i).id == recordedID) dataSize = reader.getEvent(i).dataSize;
+			}
+		}
+
+		// the internal triggers are reproduced by the simulation itself
+		if (!external || id == INVALID_EVENT){
+			char skip[256];
+			uint16_t remaining = dataSize;
+			while (remaining != 0){
+				uint16_t size = remaining < sizeof(skip) ? remaining : sizeof(skip);
+				if (!reader.readPayload(skip, size)) break;
+				remaining -= size;
+			}
+			continue;
+		}
+
+		void* data = dataSize == 0 ? nullptr : getPayloadSlot(instance.events[id]);
+		if (!reader.readPayload(data, dataSize)) break;
+
+		instance.external = true;
+		_triggerEvent(id, data);
+		instance.external = false;
+	}
+
+	// end of the journal, the owner of the replay sees it with isReplaying and stops it
+	instance.replayEnded = true;
+}
+
+void Hermes::beginExternal(){
+	getInstance().external = true;
+}
+
+void Hermes::endExternal(){
+	getInstance().external = false;
+}
+
+uint64_t Hermes::getFrame(){
+	return getInstance().frame;
+}
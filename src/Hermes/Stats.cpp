@@ -0,0 +1,185 @@
+#include "Hermes.hpp"
+#include <cstring>
+#include <chrono>
+
+#ifdef HERMES_PROFILE
+	uint64_t Hermes::profileNow(){
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void Hermes::profileCallback(CallbackStats &stats, EventStats &eventStats, uint64_t time){
+		stats.calls++;
+		stats.totalTime += time;
+		eventStats.callbackTime += time;
+
+		// bucket i hold the calls under 2^(i+8) ns
+		uint32_t bucket = 0;
+		uint64_t bound = 256;
+		while (time >= bound && bucket < LATENCY_BUCKET_COUNT - 1){
+			bound <<= 1;
+			bucket++;
+		}
+		stats.latency[bucket]++;
+	}
+
+	// one row or object per callback of a dumped event, the counters are the ones since the subscription
+	static void dumpCallbackStats(FILE* file, Hermes::StatsFormat format, uint64_t frame, const char* name, uint32_t index, const Hermes::CallbackStats &stats){
+		switch (format){
+			case Hermes::StatsFormat::CSV:
+				fprintf(file, "%llu,%s,%u,,,,,%llu,%llu", static_cast<unsigned long long>(frame), name, index,
+					static_cast<unsigned long long>(stats.totalTime), static_cast<unsigned long long>(stats.calls));
+				for (uint32_t i=0; i<Hermes::LATENCY_BUCKET_COUNT; i++){
+					fprintf(file, ",%u", stats.latency[i]);
+				}
+				fprintf(file, "\n");
+				break;
+
+			case Hermes::StatsFormat::JSON:
+				fprintf(file, "%s{\"calls\":%llu,\"time\":%llu,\"latency\":[", index == 0 ? "" : ",",
+					static_cast<unsigned long long>(stats.calls), static_cast<unsigned long long>(stats.totalTime));
+				for (uint32_t i=0; i<Hermes::LATENCY_BUCKET_COUNT; i++){
+					fprintf(file, "%s%u", i == 0 ? "" : ",", stats.latency[i]);
+				}
+				fprintf(file, "]}");
+				break;
+		}
+	}
+#endif
+
+Hermes::EventStats Hermes::getEventStats(EventID id){
+	Hermes& instance = getInstance();
+	HERMES_ASSERT(id < instance.registeredEventCount && "invalid event id");
+
+	EventType &event = instance.events[id];
+	EventStats stats;
+
+	#ifdef HERMES_PROFILE
+		stats = event.lastFrameStats;
+	#endif
+
+	stats.name = event.name;
+	stats.id = id;
+	stats.subscribers = static_cast<uint32_t>(event.callbacks->size() + event.batchCallbacks->size());
+	return stats;
+}
+
+size_t Hermes::getCallbackStats(EventID id, CallbackStats* stats, size_t maxCount){
+	Hermes& instance = getInstance();
+	HERMES_ASSERT(id < instance.registeredEventCount && "invalid event id");
+
+	EventType &event = instance.events[id];
+	size_t count = event.callbacks->size() + event.batchCallbacks->size();
+	if (!stats) return count;
+
+	size_t i = 0;
+	for (auto &callback : *event.callbacks){
+		if (i >= maxCount) return count;
+		#ifdef HERMES_PROFILE
+			stats[i] = callback.stats;
+		#else
+			stats[i] = CallbackStats();
+		#endif
+		i++;
+	}
+
+	for (auto &callback : *event.batchCallbacks){
+		if (i >= maxCount) return count;
+		#ifdef HERMES_PROFILE
+			stats[i] = callback.stats;
+		#else
+			stats[i] = CallbackStats();
+		#endif
+		i++;
+	}
+
+	return count;
+}
+
+void Hermes::dumpStats(FILE* file, StatsFormat format){
+	if (!file) return;
+
+	#ifdef HERMES_PROFILE
+		Hermes& instance = getInstance();
+		if (format == StatsFormat::JSON) fprintf(file, "{\"frame\":%llu,\"events\":[", static_cast<unsigned long long>(instance.frame));
+		bool first = true;
+
+		for (int i=0; i<instance.registeredEventCount; i++){
+			EventStats stats = getEventStats(i);
+			if (stats.triggers == 0) continue;
+
+			switch (format){
+				case StatsFormat::CSV:
+					// the event rows leave the callback columns empty
+					fprintf(file, "%llu,%s,,%u,%u,%u,%llu,%llu,",
+						static_cast<unsigned long long>(instance.frame), stats.name, stats.triggers, stats.coalesced, stats.subscribers,
+						static_cast<unsigned long long>(stats.payloadBytes), static_cast<unsigned long long>(stats.callbackTime));
+					for (uint32_t j=0; j<LATENCY_BUCKET_COUNT; j++){
+						fputc(',', file);
+					}
+					fputc('\n', file);
+					break;
+
+				case StatsFormat::JSON:
+					// the event names are identifiers, they are not escaped
+					fprintf(file, "%s{\"name\":\"%s\",\"triggers\":%u,\"coalesced\":%u,\"subscribers\":%u,\"payload\":%llu,\"time\":%llu,\"callbacks\":[",
+						first ? "" : ",", stats.name, stats.triggers, stats.coalesced, stats.subscribers,
+						static_cast<unsigned long long>(stats.payloadBytes), static_cast<unsigned long long>(stats.callbackTime));
+					break;
+			}
+
+			// the callbacks in subscription order, as getCallbackStats
+			EventType &event = instance.events[i];
+			uint32_t index = 0;
+			for (auto &callback : *event.callbacks){
+				dumpCallbackStats(file, format, instance.frame, stats.name, index++, callback.stats);
+			}
+			for (auto &callback : *event.batchCallbacks){
+				dumpCallbackStats(file, format, instance.frame, stats.name, index++, callback.stats);
+			}
+
+			if (format == StatsFormat::JSON) fprintf(file, "]}");
+			first = false;
+		}
+
+		if (format == StatsFormat::JSON) fprintf(file, "]}\n");
+	#endif
+}
+
+void Hermes::setStatsDump(const char* path, StatsFormat format){
+	Hermes& instance = getInstance();
+
+	if (instance.statsDump){
+		fclose(instance.statsDump);
+		instance.statsDump = nullptr;
+	}
+
+	if (!path) return;
+
+	instance.statsDump = fopen(path, "w");
+	if (!instance.statsDump) throw "Hermes::setStatsDump : cannot open the stats file";
+
+	instance.statsDumpFormat = format;
+	// one row per triggered event, followed by one row per callback of the event with its latency histogram
+	if (format == StatsFormat::CSV){
+		fprintf(instance.statsDump, "frame,event,callback,triggers,coalesced,subscribers,payload_bytes,callback_ns,calls");
+		for (uint32_t i=0; i + 1<LATENCY_BUCKET_COUNT; i++){
+			fprintf(instance.statsDump, ",latency_lt_%lluns", 1ull << (i + 8));
+		}
+		fprintf(instance.statsDump, ",latency_ge_%lluns\n", 1ull << (LATENCY_BUCKET_COUNT + 6));
+	}
+}
+
+void Hermes::endFrameStats(){
+	#ifdef HERMES_PROFILE
+		Hermes& instance = getInstance();
+
+		for (int i=0; i<instance.registeredEventCount; i++){
+			EventType &event = instance.events[i];
+			event.frameStats.totalTriggers = event.lastFrameStats.totalTriggers + event.frameStats.triggers;
+			event.lastFrameStats = event.frameStats;
+			event.frameStats = EventStats();
+		}
+
+		if (instance.statsDump) dumpStats(instance.statsDump, instance.statsDumpFormat);
+	#endif
+}
@@ -0,0 +1,161 @@
+#include "Hermes.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <new>
+
+static constexpr double TICKS_PER_SECOND = 1000.0;
+
+void Hermes::setClock(ClockFn clock){
+	Hermes &instance = getInstance();
+	instance.clock = clock;
+
+	if (clock && instance.secondsWheel.getCount() == 0){
+		instance.secondsWheel.reset(toTicks(Timeline::Seconds, clock()));
+	}
+}
+
+TimingWheel::Tick Hermes::toTicks(Timeline timeline, double time){
+	if (time <= 0.0) return 0;
+
+	switch (timeline){
+		case Timeline::Seconds: return static_cast<TimingWheel::Tick>(std::llround(time * TICKS_PER_SECOND));
+		case Timeline::Frames: return static_cast<TimingWheel::Tick>(std::llround(time));
+	}
+	return 0;
+}
+
+Hermes::TimerID Hermes::scheduleEvent(EventID id, Timeline timeline, double delay, double interval){
+	Hermes &instance = getInstance();
+	HERMES_ASSERT(id < instance.registeredEventCount && "event type overflow");
+	HERMES_ASSERT((timeline == Timeline::Frames || instance.clock) && "a clock is required to schedule events in seconds");
+	EventType& event = instance.events[id];
+	Horreum::CategoryScope category(Horreum::Category::Events);
+
+	// reuse a released timer or grow the timer table
+	uint32_t index = instance.freeTimer;
+	if (index != TimingWheel::INVALID){
+		instance.freeTimer = instance.timers[index].nextFree;
+	} else {
+		uint32_t capacity = instance.timerCount == 0 ? 64 : instance.timerCount * 2;
+		instance.timers = static_cast<Timer*>(HRM_REALLOC(instance.timers, sizeof(Timer) * capacity));
+
+		for (uint32_t i=instance.timerCount; i<capacity; i++){
+			new (&instance.timers[i]) Timer();
+			instance.timers[i].nextFree = i + 1 < capacity ? i + 1 : TimingWheel::INVALID;
+		}
+
+		index = instance.timerCount;
+		instance.freeTimer = instance.timers[index].nextFree;
+		instance.timerCount = capacity;
+		instance.secondsWheel.reserve(capacity);
+		instance.framesWheel.reserve(capacity);
+	}
+
+	Timer &timer = instance.timers[index];
+	timer.event = id;
+	timer.timeline = timeline;
+	timer.pending = true;
+	timer.nextFree = TimingWheel::INVALID;
+
+	// a repeating timer cannot expire more than once per tick
+	timer.interval = interval > 0.0 ? toTicks(timeline, interval) : 0;
+	if (interval > 0.0 && timer.interval == 0) timer.interval = 1;
+
+	// the payload buffer is kept with the timer slot and reused
+	if (event.dataSize > timer.payloadCapacity){
+		timer.payload = HRM_REALLOC(timer.payload, event.dataSize);
+		timer.payloadCapacity = event.dataSize;
+	}
+
+	TimingWheel &wheel = timeline == Timeline::Seconds ? instance.secondsWheel : instance.framesWheel;
+	wheel.insert(index, wheel.getCurrentTick() + toTicks(timeline, delay));
+
+	return (static_cast<TimerID>(timer.generation) << 32) | index;
+}
+
+Hermes::Timer* Hermes::getTimer(TimerID id){
+	Hermes &instance = getInstance();
+
+	uint32_t index = static_cast<uint32_t>(id & UINT32_MAX);
+	uint32_t generation = static_cast<uint32_t>(id >> 32);
+	if (index >= instance.timerCount) return nullptr;
+
+	Timer &timer = instance.timers[index];
+	if (timer.generation != generation || !timer.pending) return nullptr;
+	return &timer;
+}
+
+void* Hermes::getTimerPayload(TimerID id){
+	Timer* timer = getTimer(id);
+	HERMES_ASSERT(timer && "invalid timer");
+	return timer->payload;
+}
+
+bool Hermes::isTimerPending(TimerID id){
+	return getTimer(id) != nullptr;
+}
+
+bool Hermes::cancelTimer(TimerID id){
+	Hermes &instance = getInstance();
+	Timer* timer = getTimer(id);
+	if (!timer) return false;
+
+	uint32_t index = static_cast<uint32_t>(id & UINT32_MAX);
+	TimingWheel &wheel = timer->timeline == Timeline::Seconds ? instance.secondsWheel : instance.framesWheel;
+	wheel.remove(index);
+	releaseTimer(index);
+	return true;
+}
+
+void Hermes::releaseTimer(uint32_t index){
+	Hermes &instance = getInstance();
+	Timer &timer = instance.timers[index];
+
+	// invalidate the handles still pointing to this slot
+	timer.pending = false;
+	timer.generation++;
+	if (timer.generation == 0) timer.generation = 1;
+
+	timer.nextFree = instance.freeTimer;
+	instance.freeTimer = index;
+}
+
+void Hermes::expireTimer(uint32_t index){
+	Hermes &instance = getInstance();
+
+	// the callbacks may schedule timers and move the timer table, keep a copy of the timer
+	Timer timer = instance.timers[index];
+	uint16_t dataSize = instance.events[timer.event].dataSize;
+
+	// the payload is copied into the frame buffer, the timer one may be reused by a repeating trigger
+	void* data = nullptr;
+	if (dataSize != 0){
+		data = getPayloadSlot(instance.events[timer.event]);
+		memcpy(data, timer.payload, dataSize);
+	}
+	_triggerEvent(timer.event, data);
+
+	// the timer has been cancelled by a callback
+	Timer &current = instance.timers[index];
+	if (current.generation != timer.generation || !current.pending) return;
+
+	if (current.interval != 0){
+		TimingWheel &wheel = current.timeline == Timeline::Seconds ? instance.secondsWheel : instance.framesWheel;
+		wheel.insert(index, wheel.getCurrentTick() + current.interval);
+	} else {
+		releaseTimer(index);
+	}
+}
+
+void Hermes::updateTimers(){
+	Hermes &instance = getInstance();
+
+	instance.frame++;
+	instance.framesWheel.advance(instance.frame, &Hermes::expireTimer);
+
+	if (instance.clock){
+		instance.secondsWheel.advance(toTicks(Timeline::Seconds, instance.clock()), &Hermes::expireTimer);
+	}
+}
@@ -0,0 +1,132 @@
+#include "hermes/TimingWheel.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <new>
+
+TimingWheel::TimingWheel(){
+	for (uint32_t i=0; i<=EXPIRING; i++){
+		slots[i] = INVALID;
+	}
+}
+
+TimingWheel::~TimingWheel(){
+	HRM_FREE(nodes);
+}
+
+void TimingWheel::reserve(uint32_t capacity){
+	if (capacity <= this->capacity) return;
+
+	nodes = static_cast<Node*>(HRM_REALLOC(nodes, sizeof(Node) * capacity));
+	for (uint32_t i=this->capacity; i<capacity; i++){
+		new (&nodes[i]) Node();
+	}
+	this->capacity = capacity;
+}
+
+void TimingWheel::insert(uint32_t timer, Tick expire){
+	assert(timer < capacity && "timer out of the wheel capacity");
+	assert(nodes[timer].slot == INVALID && "timer already scheduled");
+
+	// the current tick has already been expired
+	nodes[timer].expire = expire > current ? expire : current + 1;
+	place(timer);
+	count++;
+}
+
+void TimingWheel::remove(uint32_t timer){
+	Node &node = nodes[timer];
+	if (node.slot == INVALID) return;
+
+	if (node.prev != INVALID){
+		nodes[node.prev].next = node.next;
+	} else {
+		slots[node.slot] = node.next;
+	}
+
+	if (node.next != INVALID){
+		nodes[node.next].prev = node.prev;
+	}
+
+	levelCount[node.slot / SLOT_COUNT]--;
+	node.next = INVALID;
+	node.prev = INVALID;
+	node.slot = INVALID;
+	count--;
+}
+
+void TimingWheel::reset(Tick tick){
+	assert(count == 0 && "cannot reset a wheel with pending timers");
+	current = tick;
+}
+
+void TimingWheel::place(uint32_t timer){
+	Node &node = nodes[timer];
+	Tick expire = node.expire > current ? node.expire : current;
+
+	// the level is the highest group of bits that differs from the current tick, so the slot is always ahead of the current one
+	uint32_t slot = INVALID;
+	for (uint32_t level=0; level<LEVEL_COUNT - 1; level++){
+		uint32_t shift = SLOT_BITS * (level + 1);
+		if ((expire >> shift) == (current >> shift)){
+			slot = level * SLOT_COUNT + static_cast<uint32_t>((expire >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+			break;
+		}
+	}
+
+	// the top level is a ring covering the next rotation, a slot equal to the current one is reached after a full rotation
+	if (slot == INVALID){
+		uint32_t top = SLOT_BITS * (LEVEL_COUNT - 1);
+		Tick range = static_cast<Tick>(SLOT_COUNT) << top;
+
+		if (expire - current < range){
+			slot = (LEVEL_COUNT - 1) * SLOT_COUNT + static_cast<uint32_t>((expire >> top) & (SLOT_COUNT - 1));
+		} else {
+			// out of the wheel range, park it in the last slot of the rotation, it will be placed again when cascaded
+			slot = (LEVEL_COUNT - 1) * SLOT_COUNT + static_cast<uint32_t>(((current >> top) - 1) & (SLOT_COUNT - 1));
+		}
+	}
+
+	levelCount[slot / SLOT_COUNT]++;
+	node.slot = slot;
+	node.prev = INVALID;
+	node.next = slots[slot];
+	if (node.next != INVALID){
+		nodes[node.next].prev = timer;
+	}
+	slots[slot] = timer;
+}
+
+void TimingWheel::cascade(uint32_t level){
+	uint32_t index = static_cast<uint32_t>((current >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+
+	// the upper level has to be moved down first, it may refill this slot
+	if (index == 0 && level + 1 < LEVEL_COUNT){
+		cascade(level + 1);
+	}
+
+	uint32_t timer = detach(level * SLOT_COUNT + index);
+	while (timer != INVALID){
+		uint32_t next = nodes[timer].next;
+		levelCount[level]--;
+		place(timer);
+		timer = next;
+	}
+}
+
+uint32_t TimingWheel::detach(uint32_t slot){
+	uint32_t head = slots[slot];
+	slots[slot] = INVALID;
+	return head;
+}
+
+void TimingWheel::expire(uint32_t index){
+	assert(slots[EXPIRING] == INVALID && "timers already expiring");
+
+	uint32_t head = detach(index);
+	for (uint32_t timer=head; timer!=INVALID; timer=nodes[timer].next){
+		nodes[timer].slot = EXPIRING;
+		levelCount[0]--;
+		levelCount[LEVEL_COUNT]++;
+	}
+	slots[EXPIRING] = head;
+}
@@ -0,0 +1,62 @@
+#include "horreum/FrameAllocator.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstdint>
+
+FrameAllocator::FrameAllocator(size_t frameSize, uint32_t frameCount){
+	assert(frameCount != 0 && "a frame allocator needs at least one frame");
+
+	this->frameSize = frameSize;
+	this->frameCount = frameCount;
+
+	regions = new Region[frameCount];
+	for (uint32_t i=0; i<frameCount; i++){
+		regions[i].data = static_cast<char*>(HRM_MALLOC(frameSize));
+	}
+	current = &regions[0];
+}
+
+FrameAllocator::~FrameAllocator(){
+	for (uint32_t i=0; i<frameCount; i++){
+		HRM_FREE(regions[i].data);
+	}
+	delete[] regions;
+}
+
+void FrameAllocator::beginFrame(){
+	frame++;
+	current = &regions[frame % frameCount];
+	current->used.store(0, std::memory_order_relaxed);
+}
+
+void* FrameAllocator::push(size_t size, size_t alignment){
+	assert((alignment & (alignment - 1)) == 0 && "the alignment must be a power of two");
+
+	Region &region = *current;
+	uintptr_t base = reinterpret_cast<uintptr_t>(region.data);
+	size_t used = region.used.load(std::memory_order_relaxed);
+	size_t offset;
+
+	do {
+		offset = ((base + used + alignment - 1) & ~(alignment - 1)) - base;
+		if (offset + size > frameSize) return nullptr;
+	} while (!region.used.compare_exchange_weak(used, offset + size, std::memory_order_relaxed));
+
+	return region.data + offset;
+}
+
+size_t FrameAllocator::getCurrentUsedSize() const{
+	return current->used.load(std::memory_order_relaxed);
+}
+
+size_t FrameAllocator::getMaxSize() const{
+	return frameSize;
+}
+
+uint32_t FrameAllocator::getFrameCount() const{
+	return frameCount;
+}
+
+uint64_t FrameAllocator::getFrame() const{
+	return frame;
+}
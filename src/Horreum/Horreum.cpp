@@ -0,0 +1,361 @@
+#include "horreum/Horreum.hpp"
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
+namespace{
+	// the interned call sites, an open addressing table keyed by the address of the file name literal and the line
+	// constant initialized and trivially destructible, so it can be used by the static constructors and destructors
+	struct Site{
+		std::atomic<uint32_t> state{0}; // FREE, WRITING or READY
+		const char* file = nullptr;
+		const char* function = nullptr;
+		int line = 0;
+
+		std::atomic<int64_t> liveBytes{0};
+		std::atomic<int64_t> liveCount{0};
+		std::atomic<uint64_t> totalBytes{0};
+		std::atomic<uint64_t> totalCount{0};
+	};
+
+	static constexpr uint32_t FREE = 0;
+	static constexpr uint32_t WRITING = 1;
+	static constexpr uint32_t READY = 2;
+
+	// the live counters of a category, budgets of zero are disabled
+	// an allocation updates two counters and a free two, the live count and the frame allocations are derived from them
+	// one cache line per category, so the threads allocating in different categories do not share it
+	struct alignas(64) Counters{
+		std::atomic<uint64_t> liveBytes{0};
+		std::atomic<uint64_t> peakBytes{0};
+		std::atomic<uint64_t> totalAllocations{0};
+		std::atomic<uint64_t> totalFrees{0};
+		std::atomic<uint64_t> frameStart{0}; // totalAllocations when the frame began
+		std::atomic<uint64_t> lastFrameAllocations{0};
+		std::atomic<uint64_t> softBudget{0};
+		std::atomic<uint64_t> hardBudget{0};
+	};
+
+	// the block tag holds the category in its high byte and the call site id in the low 24 bits
+	static constexpr uint32_t SITE_MASK = 0x00FFFFFF;
+	static constexpr uint32_t CATEGORY_SHIFT = 24;
+	static_assert(Horreum::MAX_CALL_SITE_COUNT <= SITE_MASK, "the call site ids must fit in the tag");
+
+	static constexpr const char* CATEGORY_NAMES[] = {"User", "ECS", "Events", "Assets", "Audio", "Render"};
+	static_assert(sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0]) == static_cast<size_t>(Horreum::Category::MAX), "a category has no name");
+
+	static Counters counters[static_cast<size_t>(Horreum::Category::MAX)];
+	static std::atomic<Horreum::BudgetCallback> budgetCallback{nullptr};
+	static thread_local Horreum::Category currentCategory = Horreum::Category::User;
+
+	static Site sites[Horreum::MAX_CALL_SITE_COUNT];
+	static std::atomic<uint32_t> sampleRate{Horreum::DEFAULT_SAMPLE_RATE};
+	static thread_local uint32_t sampleCountdown = 0;
+	static thread_local uint32_t sampleRandom = 0;
+
+	// return the site id, the index plus one, or zero when the table is full
+	uint32_t intern(const char* file, const char* function, int line){
+		uint64_t hash = (reinterpret_cast<uintptr_t>(file) ^ (static_cast<uint64_t>(line) << 40)) * 0x9E3779B97F4A7C15ull;
+		uint32_t index = static_cast<uint32_t>(hash >> 32) % Horreum::MAX_CALL_SITE_COUNT;
+
+		for (uint32_t probe=0; probe<Horreum::MAX_CALL_SITE_COUNT; probe++){
+			Site &site = sites[index];
+			uint32_t state = site.state.load(std::memory_order_acquire);
+
+			if (state == FREE){
+				if (site.state.compare_exchange_strong(state, WRITING, std::memory_order_acquire)){
+					site.file = file;
+					site.function = function;
+					site.line = line;
+					site.state.store(READY, std::memory_order_release);
+					return index + 1;
+				}
+			}
+
+			// an other thread is interning in this slot
+			while (state == WRITING){
+				state = site.state.load(std::memory_order_acquire);
+			}
+
+			if (site.file == file && site.line == line) return index + 1;
+			index = (index + 1) % Horreum::MAX_CALL_SITE_COUNT;
+		}
+
+		return 0;
+	}
+
+	// the interval between two samples is random, uniform in [1, 2 * rate - 1], so periodic allocation patterns do not alias with the rate
+	inline bool sample(){
+		if (sampleCountdown > 1){
+			sampleCountdown--;
+			return false;
+		}
+
+		if (sampleRandom == 0) sampleRandom = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&sampleRandom)) | 1;
+		sampleRandom ^= sampleRandom << 13;
+		sampleRandom ^= sampleRandom >> 17;
+		sampleRandom ^= sampleRandom << 5;
+
+		uint32_t rate = sampleRate.load(std::memory_order_relaxed);
+		sampleCountdown = 1 + sampleRandom % (2 * rate - 1);
+		return true;
+	}
+
+	inline uint32_t getCategoryIndex(void* ptr){
+		return SizeClassAllocator::getTag(ptr) >> CATEGORY_SHIFT;
+	}
+
+	void checkBudget(uint32_t category, uint64_t budget, uint64_t before, uint64_t after, bool hard){
+		if (budget == 0 || before > budget || after <= budget) return;
+
+		Horreum::BudgetCallback callback = budgetCallback.load(std::memory_order_relaxed);
+		if (callback) callback(static_cast<Horreum::Category>(category), after, budget, hard);
+	}
+
+	// a reallocation is accounted as a new allocation replacing a block of oldSize bytes, the deltas wrap around when it shrinks
+	void allocated(uint32_t category, uint64_t size, uint64_t oldSize = 0){
+		Counters &c = counters[category];
+		uint64_t delta = size - oldSize;
+		uint64_t live = c.liveBytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+		c.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t peak = c.peakBytes.load(std::memory_order_relaxed);
+		while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+		if (size <= oldSize) return;
+		checkBudget(category, c.softBudget.load(std::memory_order_relaxed), live - delta, live, false);
+		checkBudget(category, c.hardBudget.load(std::memory_order_relaxed), live - delta, live, true);
+	}
+
+	void released(uint32_t category, uint64_t size){
+		Counters &c = counters[category];
+		c.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+		c.totalFrees.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void track(void* ptr, uint32_t id){
+		if (id == 0) return;
+
+		Site &site = sites[id - 1];
+		int64_t size = static_cast<int64_t>(SizeClassAllocator::getRequestedSize(ptr));
+		site.liveBytes.fetch_add(size, std::memory_order_relaxed);
+		site.liveCount.fetch_add(1, std::memory_order_relaxed);
+		site.totalBytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+		site.totalCount.fetch_add(1, std::memory_order_relaxed);
+		SizeClassAllocator::setTag(ptr, (SizeClassAllocator::getTag(ptr) & ~SITE_MASK) | id);
+	}
+
+	void untrack(void* ptr){
+		uint32_t tag = SizeClassAllocator::getTag(ptr);
+		uint32_t id = tag & SITE_MASK;
+		if (id == 0) return;
+
+		Site &site = sites[id - 1];
+		site.liveBytes.fetch_sub(static_cast<int64_t>(SizeClassAllocator::getRequestedSize(ptr)), std::memory_order_relaxed);
+		site.liveCount.fetch_sub(1, std::memory_order_relaxed);
+		SizeClassAllocator::setTag(ptr, tag & ~SITE_MASK);
+	}
+}
+
+Horreum::CategoryScope::CategoryScope(Category category){
+	previous = currentCategory;
+	currentCategory = category;
+}
+
+Horreum::CategoryScope::~CategoryScope(){
+	currentCategory = previous;
+}
+
+Horreum::Horreum(){}
+
+Horreum::~Horreum(){
+	#ifdef HORREUM_ALLOC_LOG
+		if (initialized){
+			std::ofstream file(logFile);
+			if (file) writeReport(file);
+		}
+	#endif
+}
+
+Horreum& Horreum::getInstance(){
+	static Horreum instance;
+	return instance;
+}
+
+void Horreum::initialize(const std::filesystem::path &logFile){
+	Horreum &instance = getInstance();
+	instance.logFile = logFile;
+	instance.initialized = true;
+}
+
+void* Horreum::malloc(size_t size){
+	return malloc(size, currentCategory);
+}
+
+void* Horreum::malloc(size_t size, Category category){
+	void* ptr = SizeClassAllocator::malloc(size);
+	if (!ptr) return nullptr;
+
+	uint32_t index = static_cast<uint32_t>(category);
+	SizeClassAllocator::setTag(ptr, index << CATEGORY_SHIFT);
+	allocated(index, size);
+	return ptr;
+}
+
+void* Horreum::realloc(void *src, size_t newSize){
+	if (!src) return malloc(newSize);
+	if (newSize == 0){
+		free(src);
+		return nullptr;
+	}
+
+	uint32_t category = getCategoryIndex(src);
+	uint64_t oldSize = SizeClassAllocator::getRequestedSize(src);
+
+	// the tag, so the category, is kept by the reallocation
+	void* ptr = SizeClassAllocator::realloc(src, newSize);
+	if (!ptr) return nullptr;
+
+	allocated(category, newSize, oldSize);
+	counters[category].totalFrees.fetch_add(1, std::memory_order_relaxed);
+	return ptr;
+}
+
+void Horreum::free(void *ptr){
+	if (!ptr) return;
+	released(getCategoryIndex(ptr), SizeClassAllocator::getRequestedSize(ptr));
+	SizeClassAllocator::free(ptr);
+}
+
+void* Horreum::mallocLog(size_t size, const char *file, const char *functionName, int line){
+	void* ptr = malloc(size);
+	if (ptr && sample()) track(ptr, intern(file, functionName, line));
+	return ptr;
+}
+
+void* Horreum::reallocLog(void *src, size_t newSize, const char *file, const char *functionName, int line){
+	// the block is accounted to the site of its last reallocation
+	if (src) untrack(src);
+
+	void* ptr = realloc(src, newSize);
+	if (ptr && sample()) track(ptr, intern(file, functionName, line));
+	return ptr;
+}
+
+void Horreum::freeLog(void *ptr){
+	if (!ptr) return;
+	untrack(ptr);
+	free(ptr);
+}
+
+void Horreum::setSampleRate(uint32_t rate){
+	sampleRate.store(rate == 0 ? 1 : rate, std::memory_order_relaxed);
+}
+
+uint32_t Horreum::getSampleRate(){
+	return sampleRate.load(std::memory_order_relaxed);
+}
+
+size_t Horreum::getCallSites(CallSite* result, size_t maxCount){
+	uint64_t rate = getSampleRate();
+	std::vector<CallSite> merged;
+
+	for (uint32_t i=0; i<MAX_CALL_SITE_COUNT; i++){
+		Site &site = sites[i];
+		if (site.state.load(std::memory_order_acquire) != READY) continue;
+
+		// the same file and line can be interned once per translation unit (inline functions)
+		auto it = std::find_if(merged.begin(), merged.end(), [&](const CallSite &other){
+			return other.line == site.line && strcmp(other.file, site.file) == 0;
+		});
+		if (it == merged.end()){
+			CallSite callSite;
+			callSite.file = site.file;
+			callSite.function = site.function;
+			callSite.line = site.line;
+			merged.push_back(callSite);
+			it = merged.end() - 1;
+		}
+
+		int64_t liveBytes = site.liveBytes.load(std::memory_order_relaxed);
+		int64_t liveCount = site.liveCount.load(std::memory_order_relaxed);
+		it->liveBytes += liveBytes > 0 ? static_cast<uint64_t>(liveBytes) * rate : 0;
+		it->liveCount += liveCount > 0 ? static_cast<uint64_t>(liveCount) * rate : 0;
+		it->totalBytes += site.totalBytes.load(std::memory_order_relaxed) * rate;
+		it->totalCount += site.totalCount.load(std::memory_order_relaxed) * rate;
+	}
+
+	std::sort(merged.begin(), merged.end(), [](const CallSite &a, const CallSite &b){
+		return a.liveBytes > b.liveBytes;
+	});
+
+	if (result){
+		size_t count = std::min(maxCount, merged.size());
+		std::copy(merged.begin(), merged.begin() + count, result);
+	}
+	return merged.size();
+}
+
+void Horreum::writeReport(std::ostream &stream){
+	size_t count = getCallSites(nullptr, 0);
+	std::vector<CallSite> callSites(count);
+	count = getCallSites(callSites.data(), count);
+
+	// the values are estimated, the sampled counters multiplied by the sample rate
+	stream << "# sample rate " << getSampleRate() << "\n";
+	stream << "file,function,line,live_bytes,live_count,total_bytes,total_count\n";
+
+	for (size_t i=0; i<count && i<callSites.size(); i++){
+		CallSite &site = callSites[i];
+		stream << site.file << "," << site.function << "," << site.line << "," << site.liveBytes << "," << site.liveCount << "," << site.totalBytes << "," << site.totalCount << "\n";
+	}
+}
+
+void Horreum::setCategory(Category category){
+	currentCategory = category;
+}
+
+Horreum::Category Horreum::getCategory(){
+	return currentCategory;
+}
+
+Horreum::Category Horreum::getCategory(void* ptr){
+	return static_cast<Category>(getCategoryIndex(ptr));
+}
+
+const char* Horreum::getCategoryName(Category category){
+	if (category >= Category::MAX) return "Unknown";
+	return CATEGORY_NAMES[static_cast<size_t>(category)];
+}
+
+Horreum::CategoryStats Horreum::getCategoryStats(Category category){
+	Counters &c = counters[static_cast<size_t>(category)];
+
+	CategoryStats stats;
+	stats.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+	stats.totalAllocations = c.totalAllocations.load(std::memory_order_relaxed);
+	stats.liveCount = stats.totalAllocations - c.totalFrees.load(std::memory_order_relaxed);
+	stats.frameAllocations = c.lastFrameAllocations.load(std::memory_order_relaxed);
+	stats.softBudget = c.softBudget.load(std::memory_order_relaxed);
+	stats.hardBudget = c.hardBudget.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void Horreum::setBudget(Category category, uint64_t softBudget, uint64_t hardBudget){
+	Counters &c = counters[static_cast<size_t>(category)];
+	c.softBudget.store(softBudget, std::memory_order_relaxed);
+	c.hardBudget.store(hardBudget, std::memory_order_relaxed);
+}
+
+void Horreum::setBudgetCallback(BudgetCallback callback){
+	budgetCallback.store(callback, std::memory_order_relaxed);
+}
+
+void Horreum::beginFrame(){
+	for (Counters &c : counters){
+		uint64_t total = c.totalAllocations.load(std::memory_order_relaxed);
+		c.lastFrameAllocations.store(total - c.frameStart.exchange(total, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
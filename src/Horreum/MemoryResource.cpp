@@ -0,0 +1,109 @@
+#include "horreum/MemoryResource.hpp"
+#include <new>
+
+// ====================================== Horreum
+
+HorreumResource::HorreumResource(Horreum::Category category) : category{category}{}
+
+void* HorreumResource::do_allocate(size_t bytes, size_t alignment){
+	if (alignment > SizeClassAllocator::HEADER_SIZE){
+		return ::operator new(bytes, std::align_val_t(alignment));
+	}
+
+	void* ptr = Horreum::malloc(bytes, category);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void HorreumResource::do_deallocate(void* ptr, size_t bytes, size_t alignment){
+	if (alignment > SizeClassAllocator::HEADER_SIZE){
+		::operator delete(ptr, bytes, std::align_val_t(alignment));
+		return;
+	}
+	Horreum::free(ptr);
+}
+
+bool HorreumResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	// every block knows its category, any Horreum resource can free it
+	return dynamic_cast<const HorreumResource*>(&other) != nullptr;
+}
+
+// ====================================== pool
+
+PoolResource::PoolResource(Horreum::Category category, size_t firstPageCount) : upstream{category}, firstPageCount{firstPageCount}{
+	pthread_mutex_init(&poolMutex, nullptr);
+}
+
+PoolResource::~PoolResource(){
+	for (size_t i=0; i<POOL_COUNT; i++){
+		delete pools[i].load(std::memory_order_relaxed);
+	}
+	pthread_mutex_destroy(&poolMutex);
+}
+
+PoolAllocator* PoolResource::getPool(size_t index){
+	PoolAllocator* pool = pools[index].load(std::memory_order_acquire);
+	if (pool) return pool;
+
+	pthread_mutex_lock(&poolMutex);
+	pool = pools[index].load(std::memory_order_relaxed);
+	if (!pool){
+		// the pages of the pool are accounted to the category of the resource
+		Horreum::CategoryScope scope(upstream.getCategory());
+		pool = new PoolAllocator((index + 1) * POOL_STEP, firstPageCount);
+		pools[index].store(pool, std::memory_order_release);
+	}
+	pthread_mutex_unlock(&poolMutex);
+	return pool;
+}
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment){
+	// the pool elements are 16 bytes aligned, their size being a multiple of 16
+	if (bytes == 0 || bytes > MAX_POOLED_SIZE || alignment > POOL_STEP){
+		return upstream.allocate(bytes, alignment);
+	}
+
+	void* ptr = getPool((bytes - 1) / POOL_STEP)->getElement();
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void PoolResource::do_deallocate(void* ptr, size_t bytes, size_t alignment){
+	if (bytes == 0 || bytes > MAX_POOLED_SIZE || alignment > POOL_STEP){
+		upstream.deallocate(ptr, bytes, alignment);
+		return;
+	}
+	getPool((bytes - 1) / POOL_STEP)->restoreElement(ptr);
+}
+
+bool PoolResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	return this == &other;
+}
+
+// ====================================== stack
+
+void* StackResource::do_allocate(size_t bytes, size_t alignment){
+	void* ptr = allocator.push(bytes, alignment);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void StackResource::do_deallocate(void*, size_t, size_t){}
+
+bool StackResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	return this == &other;
+}
+
+// ====================================== arena
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment){
+	void* ptr = arena.push(bytes, alignment);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void ArenaResource::do_deallocate(void*, size_t, size_t){}
+
+bool ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	return this == &other;
+}
@@ -0,0 +1,203 @@
+#include "horreum/PoolAllocator.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+PoolAllocator::PoolAllocator(size_t elementSize, size_t elementCount){
+	// the free elements hold the index of the next one
+	// the elements keep the alignment of malloc, the pages having it, so any component type (simd, alignas(16)) fits
+	constexpr size_t alignment = alignof(std::max_align_t);
+	this->elementSize = elementSize < alignment ? alignment : (elementSize + alignment - 1) & ~(alignment - 1);
+	firstPageCount = elementCount == 0 ? 64 : static_cast<uint32_t>(elementCount);
+	category = Horreum::getCategory();
+
+	head.store(pack(INVALID, 0), std::memory_order_relaxed);
+	pthread_mutex_init(&growMutex, nullptr);
+
+	grow();
+}
+
+PoolAllocator::~PoolAllocator(){
+	uint32_t count = pageCount.load(std::memory_order_acquire);
+	for (uint32_t i=0; i<count; i++){
+		HRM_FREE(pages[i]);
+	}
+	pthread_mutex_destroy(&growMutex);
+}
+
+char* PoolAllocator::getAddress(uint32_t index){
+	// the page p starts at firstPageCount * (2^p - 1)
+	uint32_t q = index / firstPageCount + 1;
+	uint32_t page = 31 - __builtin_clz(q);
+	size_t offset = index - static_cast<size_t>(firstPageCount) * ((1u << page) - 1);
+	return pages[page] + offset * elementSize;
+}
+
+uint32_t PoolAllocator::getIndex(void* element){
+	char* ptr = static_cast<char*>(element);
+	uint32_t count = pageCount.load(std::memory_order_acquire);
+
+	for (uint32_t i=0; i<count; i++){
+		size_t pageSize = static_cast<size_t>(firstPageCount) << i;
+		if (ptr >= pages[i] && ptr < pages[i] + pageSize * elementSize){
+			size_t first = static_cast<size_t>(firstPageCount) * ((1u << i) - 1);
+			return static_cast<uint32_t>(first + (ptr - pages[i]) / elementSize);
+		}
+	}
+
+	assert(false && "the element does not belong to the pool");
+	return INVALID;
+}
+
+std::atomic<uint32_t>& PoolAllocator::getLink(uint32_t index){
+	return *reinterpret_cast<std::atomic<uint32_t>*>(getAddress(index));
+}
+
+void PoolAllocator::pushChain(uint32_t first, uint32_t last, uint32_t count){
+	uint64_t old = head.load(std::memory_order_acquire);
+	do {
+		getLink(last).store(getHeadIndex(old), std::memory_order_relaxed);
+	} while (!head.compare_exchange_weak(old, pack(first, getHeadTag(old) + 1), std::memory_order_release, std::memory_order_acquire));
+
+	if (count != 0) elementUsedCount.fetch_sub(count, std::memory_order_relaxed);
+}
+
+uint32_t PoolAllocator::popChain(void** elements, uint32_t count){
+	uint64_t old = head.load(std::memory_order_acquire);
+
+	while (true){
+		uint32_t index = getHeadIndex(old);
+		if (index == INVALID) return 0;
+
+		// the links may be overwritten by a concurrent pop, they are only trusted if the head did not move (same tag)
+		uint32_t capacity = static_cast<uint32_t>(getMaxElementSize());
+		uint32_t popped = 0;
+		uint32_t next = index;
+		while (popped < count && next != INVALID && next < capacity){
+			elements[popped++] = getAddress(next);
+			next = getLink(next).load(std::memory_order_relaxed);
+		}
+
+		if (next != INVALID && next >= capacity){
+			old = head.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (head.compare_exchange_weak(old, pack(next, getHeadTag(old) + 1), std::memory_order_acquire, std::memory_order_acquire)){
+			elementUsedCount.fetch_add(popped, std::memory_order_relaxed);
+			return popped;
+		}
+	}
+}
+
+bool PoolAllocator::grow(){
+	pthread_mutex_lock(&growMutex);
+
+	// an other thread may have grown the pool or restored elements meanwhile
+	if (getHeadIndex(head.load(std::memory_order_acquire)) != INVALID){
+		pthread_mutex_unlock(&growMutex);
+		return true;
+	}
+
+	uint32_t page = pageCount.load(std::memory_order_relaxed);
+	size_t first = static_cast<size_t>(firstPageCount) * ((1u << page) - 1);
+	size_t count = static_cast<size_t>(firstPageCount) << page;
+
+	if (page == MAX_PAGE_COUNT || first + count >= INVALID){
+		pthread_mutex_unlock(&growMutex);
+		return false;
+	}
+
+	// the growing thread can be of any category
+	Horreum::CategoryScope scope(category);
+	pages[page] = static_cast<char*>(HRM_MALLOC(count * elementSize));
+	if (!pages[page]){
+		pthread_mutex_unlock(&growMutex);
+		return false;
+	}
+
+	for (size_t i=0; i<count-1; i++){
+		new (pages[page] + i * elementSize) std::atomic<uint32_t>(static_cast<uint32_t>(first + i + 1));
+	}
+	new (pages[page] + (count - 1) * elementSize) std::atomic<uint32_t>(INVALID);
+
+	pageCount.store(page + 1, std::memory_order_release);
+	pushChain(static_cast<uint32_t>(first), static_cast<uint32_t>(first + count - 1), 0);
+
+	pthread_mutex_unlock(&growMutex);
+	return true;
+}
+
+void* PoolAllocator::getElement(){
+	void* element;
+	while (popChain(&element, 1) == 0){
+		if (!grow()) return nullptr;
+	}
+	return element;
+}
+
+void PoolAllocator::restoreElement(void* element){
+	if (!element) return;
+	uint32_t index = getIndex(element);
+	pushChain(index, index, 1);
+}
+
+size_t PoolAllocator::getRemainingElementCount(){
+	return getMaxElementSize() - getUsedElementsCount();
+}
+
+size_t PoolAllocator::getElementSize(){
+	return elementSize;
+}
+
+size_t PoolAllocator::getMaxElementSize(){
+	return static_cast<size_t>(firstPageCount) * ((1u << pageCount.load(std::memory_order_acquire)) - 1);
+}
+
+size_t PoolAllocator::getUsedElementsCount(){
+	return elementUsedCount.load(std::memory_order_relaxed);
+}
+
+// ====================================== magazine
+
+PoolAllocator::Magazine::Magazine(PoolAllocator &pool) : pool{pool}{}
+
+PoolAllocator::Magazine::~Magazine(){
+	while (count != 0){
+		pool.restoreElement(elements[--count]);
+	}
+}
+
+void* PoolAllocator::Magazine::getElement(){
+	if (count == 0){
+		while ((count = pool.popChain(elements, CAPACITY / 2)) == 0){
+			if (!pool.grow()) return nullptr;
+		}
+	}
+	return elements[--count];
+}
+
+void PoolAllocator::Magazine::restoreElement(void* element){
+	if (!element) return;
+
+	if (count == CAPACITY){
+		// give the older half back to the pool as one chain
+		uint32_t half = CAPACITY / 2;
+		uint32_t first = pool.getIndex(elements[0]);
+		uint32_t previous = first;
+		for (uint32_t i=1; i<half; i++){
+			uint32_t index = pool.getIndex(elements[i]);
+			pool.getLink(previous).store(index, std::memory_order_relaxed);
+			previous = index;
+		}
+		pool.pushChain(first, previous, half);
+
+		for (uint32_t i=0; i<half; i++){
+			elements[i] = elements[i + half];
+		}
+		count = half;
+	}
+
+	elements[count++] = element;
+}
@@ -0,0 +1,65 @@
+#include "horreum/SharedStackAllocator.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstdint>
+
+SharedStackAllocator::SharedStackAllocator(size_t size){
+	data = HRM_MALLOC(size);
+	maxSize = size;
+}
+
+SharedStackAllocator::~SharedStackAllocator(){
+	HRM_FREE(data);
+}
+
+void* SharedStackAllocator::pushLeft(size_t size, size_t alignment){
+	assert((alignment & (alignment - 1)) == 0 && "the alignment must be a power of two");
+
+	uintptr_t base = reinterpret_cast<uintptr_t>(data);
+	size_t offset = ((base + sizeUsedLeft + alignment - 1) & ~(alignment - 1)) - base;
+	if (offset + size + sizeUsedRight > maxSize) return nullptr;
+
+	sizeUsedLeft = offset + size;
+	return static_cast<char*>(data) + offset;
+}
+
+void* SharedStackAllocator::pushRight(size_t size, size_t alignment){
+	assert((alignment & (alignment - 1)) == 0 && "the alignment must be a power of two");
+
+	// the right stack grows downward, the block starts at the aligned address below its top
+	uintptr_t base = reinterpret_cast<uintptr_t>(data);
+	uintptr_t top = base + maxSize - sizeUsedRight;
+	if (size > top - base) return nullptr;
+
+	uintptr_t address = (top - size) & ~(alignment - 1);
+	if (address < base + sizeUsedLeft) return nullptr;
+
+	sizeUsedRight = base + maxSize - address;
+	return reinterpret_cast<void*>(address);
+}
+
+size_t SharedStackAllocator::getCurrentUsedSizeLeft() const{
+	return sizeUsedLeft;
+}
+
+size_t SharedStackAllocator::getCurrentUsedSizeRight() const{
+	return sizeUsedRight;
+}
+
+void SharedStackAllocator::setCurrentUsedSizeLeft(size_t size){
+	assert(size + sizeUsedRight <= maxSize && "shared stack allocator overflow");
+	sizeUsedLeft = size;
+}
+
+void SharedStackAllocator::setCurrentUsedSizeRight(size_t size){
+	assert(size + sizeUsedLeft <= maxSize && "shared stack allocator overflow");
+	sizeUsedRight = size;
+}
+
+size_t SharedStackAllocator::getTotalUsedSize() const{
+	return sizeUsedLeft + sizeUsedRight;
+}
+
+size_t SharedStackAllocator::getMaxSize() const{
+	return maxSize;
+}
@@ -0,0 +1,264 @@
+#include "horreum/SizeClassAllocator.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <atomic>
+#include <thread>
+
+namespace{
+	static constexpr uint32_t LARGE_CLASS = UINT32_MAX;
+
+	struct Header{
+		uint32_t sizeClass;
+		uint32_t tag; // free for the callers, see SizeClassAllocator::setTag
+		uint64_t size; // the requested size
+	};
+	static_assert(sizeof(Header) == SizeClassAllocator::HEADER_SIZE, "the header size must keep the blocks aligned");
+
+	// a cached block, the link is stored in place of the header
+	struct FreeBlock{
+		FreeBlock* next;
+	};
+
+	// the central free list of a size class, the lock is only held to move whole batches
+	// a spin lock, constant initialized, so it can be used before the static constructors run
+	struct CentralList{
+		std::atomic_flag lock = ATOMIC_FLAG_INIT;
+		FreeBlock* blocks = nullptr;
+		char* spanCursor = nullptr; // the part of the last span not carved yet
+		char* spanEnd = nullptr;
+	};
+
+	// trivially destructible, it stays valid for the frees made by the static destructors
+	struct ThreadCache{
+		FreeBlock* blocks[SizeClassAllocator::CLASS_COUNT];
+		uint32_t counts[SizeClassAllocator::CLASS_COUNT];
+		bool registered;
+	};
+
+	struct CacheFlusher{
+		~CacheFlusher(){
+			SizeClassAllocator::flushThreadCache();
+		}
+	};
+
+	static CentralList central[SizeClassAllocator::CLASS_COUNT];
+	static thread_local ThreadCache cache;
+
+	inline void lock(CentralList &list){
+		while (list.lock.test_and_set(std::memory_order_acquire)){
+			std::this_thread::yield();
+		}
+	}
+
+	inline void unlock(CentralList &list){
+		list.lock.clear(std::memory_order_release);
+	}
+
+	inline size_t getBlockSize(uint32_t sizeClass){
+		return SizeClassAllocator::HEADER_SIZE + SizeClassAllocator::getClassSize(sizeClass);
+	}
+
+	// the count of blocks moved at once between a thread cache and the central list, around 8 KB
+	inline uint32_t getBatchSize(uint32_t sizeClass){
+		size_t count = 8 * 1024 / getBlockSize(sizeClass);
+		if (count < 4) return 4;
+		if (count > 64) return 64;
+		return static_cast<uint32_t>(count);
+	}
+
+	void registerThreadCache(){
+		static thread_local CacheFlusher flusher;
+		(void)flusher;
+		cache.registered = true;
+	}
+
+	FreeBlock* refill(uint32_t sizeClass){
+		if (!cache.registered) registerThreadCache();
+
+		CentralList &list = central[sizeClass];
+		uint32_t batch = getBatchSize(sizeClass);
+		size_t blockSize = getBlockSize(sizeClass);
+
+		FreeBlock* blocks = nullptr;
+		uint32_t count = 0;
+
+		lock(list);
+
+		while (count < batch && list.blocks){
+			FreeBlock* block = list.blocks;
+			list.blocks = block->next;
+			block->next = blocks;
+			blocks = block;
+			count++;
+		}
+
+		while (count < batch){
+			if (list.spanCursor + blockSize > list.spanEnd){
+				char* span = static_cast<char*>(std::malloc(SizeClassAllocator::SPAN_SIZE));
+				if (!span) break;
+				list.spanCursor = span;
+				list.spanEnd = span + SizeClassAllocator::SPAN_SIZE;
+			}
+
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(list.spanCursor);
+			list.spanCursor += blockSize;
+			block->next = blocks;
+			blocks = block;
+			count++;
+		}
+
+		unlock(list);
+
+		cache.blocks[sizeClass] = blocks;
+		cache.counts[sizeClass] = count;
+		return blocks;
+	}
+
+	// give the given count of cached blocks back to the central list
+	void release(uint32_t sizeClass, uint32_t count){
+		FreeBlock* first = cache.blocks[sizeClass];
+		if (!first || count == 0) return;
+
+		FreeBlock* last = first;
+		uint32_t released = 1;
+		while (released < count && last->next){
+			last = last->next;
+			released++;
+		}
+
+		cache.blocks[sizeClass] = last->next;
+		cache.counts[sizeClass] -= released;
+
+		CentralList &list = central[sizeClass];
+		lock(list);
+		last->next = list.blocks;
+		list.blocks = first;
+		unlock(list);
+	}
+}
+
+uint32_t SizeClassAllocator::getSizeClass(size_t size){
+	// 16 bytes steps up to 128, then 4 classes per power of two
+	if (size <= 128) return size == 0 ? 0 : static_cast<uint32_t>((size + 15) / 16 - 1);
+
+	size_t s = size - 1;
+	uint32_t shift = 7;
+	while ((s >> (shift + 1)) != 0) shift++;
+	return static_cast<uint32_t>(8 + (shift - 7) * 4 + ((s >> (shift - 2)) - 4));
+}
+
+size_t SizeClassAllocator::getClassSize(uint32_t sizeClass){
+	if (sizeClass < 8) return (sizeClass + 1) * 16;
+
+	size_t base = static_cast<size_t>(128) << ((sizeClass - 8) / 4);
+	return base + ((sizeClass - 8) % 4 + 1) * (base / 4);
+}
+
+void* SizeClassAllocator::malloc(size_t size){
+	if (size > MAX_SMALL_SIZE){
+		Header* header = static_cast<Header*>(std::malloc(HEADER_SIZE + size));
+		if (!header) return nullptr;
+		header->sizeClass = LARGE_CLASS;
+		header->tag = 0;
+		header->size = size;
+		return header + 1;
+	}
+
+	uint32_t sizeClass = getSizeClass(size);
+	FreeBlock* block = cache.blocks[sizeClass];
+	if (!block){
+		block = refill(sizeClass);
+		if (!block) return nullptr;
+	}
+
+	cache.blocks[sizeClass] = block->next;
+	cache.counts[sizeClass]--;
+
+	Header* header = reinterpret_cast<Header*>(block);
+	header->sizeClass = sizeClass;
+	header->tag = 0;
+	header->size = size;
+	return header + 1;
+}
+
+void SizeClassAllocator::free(void* ptr){
+	if (!ptr) return;
+
+	Header* header = static_cast<Header*>(ptr) - 1;
+	uint32_t sizeClass = header->sizeClass;
+
+	if (sizeClass == LARGE_CLASS){
+		std::free(header);
+		return;
+	}
+
+	assert(sizeClass < CLASS_COUNT && "freeing a block that does not come from the allocator");
+	if (!cache.registered) registerThreadCache();
+
+	// the block joins the cache of the freeing thread, whatever the thread it was allocated from
+	FreeBlock* block = reinterpret_cast<FreeBlock*>(header);
+	block->next = cache.blocks[sizeClass];
+	cache.blocks[sizeClass] = block;
+
+	uint32_t batch = getBatchSize(sizeClass);
+	if (++cache.counts[sizeClass] > batch * 2){
+		release(sizeClass, batch);
+	}
+}
+
+void* SizeClassAllocator::realloc(void* ptr, size_t newSize){
+	if (!ptr) return malloc(newSize);
+	if (newSize == 0){
+		free(ptr);
+		return nullptr;
+	}
+
+	Header* header = static_cast<Header*>(ptr) - 1;
+
+	if (header->sizeClass == LARGE_CLASS){
+		if (newSize > MAX_SMALL_SIZE){
+			header = static_cast<Header*>(std::realloc(header, HEADER_SIZE + newSize));
+			if (!header) return nullptr;
+			header->size = newSize;
+			return header + 1;
+		}
+	} else if (getSizeClass(newSize) == header->sizeClass){
+		// still fits the same class
+		header->size = newSize;
+		return ptr;
+	}
+
+	void* block = malloc(newSize);
+	if (!block) return nullptr;
+	setTag(block, header->tag);
+
+	size_t copySize = header->size < newSize ? header->size : newSize;
+	memcpy(block, ptr, copySize);
+	free(ptr);
+	return block;
+}
+
+size_t SizeClassAllocator::getSize(void* ptr){
+	Header* header = static_cast<Header*>(ptr) - 1;
+	if (header->sizeClass == LARGE_CLASS) return header->size;
+	return getClassSize(header->sizeClass);
+}
+
+size_t SizeClassAllocator::getRequestedSize(void* ptr){
+	return static_cast<size_t>((static_cast<Header*>(ptr) - 1)->size);
+}
+
+uint32_t SizeClassAllocator::getTag(void* ptr){
+	return (static_cast<Header*>(ptr) - 1)->tag;
+}
+
+void SizeClassAllocator::setTag(void* ptr, uint32_t tag){
+	(static_cast<Header*>(ptr) - 1)->tag = tag;
+}
+
+void SizeClassAllocator::flushThreadCache(){
+	for (uint32_t i=0; i<CLASS_COUNT; i++){
+		release(i, cache.counts[i]);
+	}
+}
@@ -0,0 +1,47 @@
+#include "horreum/StackAllocator.hpp"
+#include "horreum/Horreum.hpp"
+#include <cassert>
+#include <cstdint>
+
+StackAllocator::StackAllocator(size_t size){
+	data = HRM_MALLOC(size);
+	maxSize = size;
+}
+
+StackAllocator::~StackAllocator(){
+	HRM_FREE(data);
+}
+
+void StackAllocator::clear(){
+	currentUsedSize = 0;
+}
+
+void* StackAllocator::push(size_t size, size_t alignment){
+	assert((alignment & (alignment - 1)) == 0 && "the alignment must be a power of two");
+
+	// align the address, not the offset, the buffer itself is only 16 bytes aligned
+	uintptr_t base = reinterpret_cast<uintptr_t>(data);
+	size_t offset = ((base + currentUsedSize + alignment - 1) & ~(alignment - 1)) - base;
+	if (offset + size > maxSize) return nullptr;
+
+	currentUsedSize = offset + size;
+	return static_cast<char*>(data) + offset;
+}
+
+size_t StackAllocator::getCurrentUsedSize(){
+	return currentUsedSize;
+}
+
+size_t StackAllocator::getMaxSize(){
+	return maxSize;
+}
+
+void StackAllocator::setCurrentUsedSize(size_t size){
+	assert(size <= maxSize && "stack allocator overflow");
+	currentUsedSize = size;
+}
+
+void StackAllocator::rollback(Marker marker){
+	assert(marker <= currentUsedSize && "rolling back to a marker above the top of the stack");
+	currentUsedSize = marker;
+}
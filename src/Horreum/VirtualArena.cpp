@@ -0,0 +1,106 @@
+#include "horreum/VirtualArena.hpp"
+#include <cassert>
+#include <cstdint>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+static size_t getPageSize(){
+	#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return static_cast<size_t>(info.dwPageSize);
+	#else
+		return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	#endif
+}
+
+static size_t roundUp(size_t size, size_t granularity){
+	return (size + granularity - 1) / granularity * granularity;
+}
+
+VirtualArena::VirtualArena(size_t reserveSize, size_t commitSize){
+	size_t pageSize = getPageSize();
+	this->commitSize = roundUp(commitSize == 0 ? pageSize : commitSize, pageSize);
+	reservedSize = roundUp(reserveSize, this->commitSize);
+
+	#ifdef _WIN32
+		data = static_cast<char*>(VirtualAlloc(nullptr, reservedSize, MEM_RESERVE, PAGE_NOACCESS));
+	#else
+		void* ptr = mmap(nullptr, reservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		data = ptr == MAP_FAILED ? nullptr : static_cast<char*>(ptr);
+	#endif
+
+	if (!data) throw "VirtualArena : failed to reserve the address range";
+}
+
+VirtualArena::~VirtualArena(){
+	#ifdef _WIN32
+		VirtualFree(data, 0, MEM_RELEASE);
+	#else
+		munmap(data, reservedSize);
+	#endif
+}
+
+bool VirtualArena::commit(size_t size){
+	// commit by whole commitSize steps, from the current committed top
+	size_t target = roundUp(size, commitSize);
+	if (target > reservedSize) return false;
+
+	char* start = data + committedSize;
+	size_t length = target - committedSize;
+
+	#ifdef _WIN32
+		if (!VirtualAlloc(start, length, MEM_COMMIT, PAGE_READWRITE)) return false;
+	#else
+		if (mprotect(start, length, PROT_READ | PROT_WRITE) != 0) return false;
+	#endif
+
+	committedSize = target;
+	return true;
+}
+
+void VirtualArena::decommit(size_t size){
+	size_t target = roundUp(size, commitSize);
+	if (target >= committedSize) return;
+
+	char* start = data + target;
+	size_t length = committedSize - target;
+
+	#ifdef _WIN32
+		VirtualFree(start, length, MEM_DECOMMIT);
+	#else
+		// drop the physical pages and make the range inaccessible again
+		madvise(start, length, MADV_DONTNEED);
+		mprotect(start, length, PROT_NONE);
+	#endif
+
+	committedSize = target;
+}
+
+void* VirtualArena::push(size_t size, size_t alignment){
+	assert((alignment & (alignment - 1)) == 0 && "the alignment must be a power of two");
+
+	uintptr_t base = reinterpret_cast<uintptr_t>(data);
+	size_t offset = ((base + currentUsedSize + alignment - 1) & ~(alignment - 1)) - base;
+	if (offset + size > reservedSize) return nullptr;
+
+	if (offset + size > committedSize && !commit(offset + size)) return nullptr;
+
+	currentUsedSize = offset + size;
+	return data + offset;
+}
+
+void VirtualArena::clear(bool decommit){
+	rollback(0, decommit);
+}
+
+void VirtualArena::rollback(Marker marker, bool decommit){
+	assert(marker <= currentUsedSize && "rolling back to a marker above the top of the arena");
+	currentUsedSize = marker;
+	if (decommit) this->decommit(marker);
+}
@@ -0,0 +1,131 @@
+#include "odin/FileWatcher.hpp"
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+
+#include <sys/inotify.h>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+
+static uint64_t getMilliseconds(){
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FileWatcher::FileWatcher(const char* root, uint32_t debounceMilliseconds, Callback callback, void* userData) : root{root}, debounceMilliseconds{debounceMilliseconds}, callback{callback}, userData{userData}{
+	while (this->root.size() > 1 && this->root.back() == '/') this->root.pop_back();
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) throw "failed to initialize inotify";
+
+	addDirectory(this->root);
+	if (directories.empty()){
+		close(fd);
+		throw "failed to watch the directory";
+	}
+
+	if (pthread_create(&thread, nullptr, &FileWatcher::run, this) != 0){
+		close(fd);
+		throw "failed to create the watcher thread";
+	}
+}
+
+FileWatcher::~FileWatcher(){
+	running.store(false, std::memory_order_relaxed);
+	pthread_join(thread, nullptr);
+	close(fd);
+}
+
+void FileWatcher::addDirectory(const std::string &path){
+	// the editors often save by writing a new file and moving it over the old one
+	int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (wd < 0) return;
+	directories[wd] = path;
+
+	DIR* dir = opendir(path.c_str());
+	if (!dir) return;
+
+	while (dirent* entry = readdir(dir)){
+		if (entry->d_type != DT_DIR || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		addDirectory(path + "/" + entry->d_name);
+	}
+	closedir(dir);
+}
+
+void FileWatcher::readEvents(){
+	alignas(inotify_event) char buffer[4096];
+
+	while (true){
+		ssize_t size = read(fd, buffer, sizeof(buffer));
+		if (size <= 0) return;
+
+		for (char* ptr = buffer; ptr < buffer + size;){
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+			ptr += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_IGNORED){
+				directories.erase(event->wd);
+				continue;
+			}
+
+			auto it = directories.find(event->wd);
+			if (it == directories.end() || event->len == 0) continue;
+			std::string path = it->second + "/" + event->name;
+
+			if (event->mask & IN_ISDIR){
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) addDirectory(path);
+				continue;
+			}
+
+			// a file being written is only reported once closed, IN_CREATE alone is not a change
+			if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) pending[path] = getMilliseconds();
+		}
+	}
+}
+
+void FileWatcher::flush(){
+	uint64_t now = getMilliseconds();
+	std::vector<std::string> ready;
+
+	for (auto it = pending.begin(); it != pending.end();){
+		if (now - it->second >= debounceMilliseconds){
+			ready.push_back(it->first);
+			it = pending.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	for (const std::string &path : ready){
+		callback(path.c_str(), userData);
+	}
+}
+
+void* FileWatcher::run(void* data){
+	FileWatcher* watcher = static_cast<FileWatcher*>(data);
+	pollfd descriptor = {watcher->fd, POLLIN, 0};
+
+	// the timeout bounds the time to stop and the debounce precision
+	while (watcher->running.load(std::memory_order_relaxed)){
+		if (poll(&descriptor, 1, 20) > 0) watcher->readEvents();
+		watcher->flush();
+	}
+	return nullptr;
+}
+
+#else
+
+FileWatcher::FileWatcher(const char* root, uint32_t debounceMilliseconds, Callback callback, void* userData) : root{root}, debounceMilliseconds{debounceMilliseconds}, callback{callback}, userData{userData}{
+	throw "file watching is not supported on this platform";
+}
+
+FileWatcher::~FileWatcher(){}
+
+void* FileWatcher::run(void*){return nullptr;}
+void FileWatcher::addDirectory(const std::string&){}
+void FileWatcher::readEvents(){}
+void FileWatcher::flush(){}
+
+#endif
@@ -0,0 +1,1084 @@
+#include "Odin.hpp"
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+// set while a loader task runs, its blocking loads run the queued ones instead of waiting for a free loader
+static thread_local bool inLoader = false;
+
+Odin::Shard::Shard(){
+	pthread_rwlock_init(&lock, nullptr);
+}
+
+Odin::Shard::~Shard(){
+	pthread_rwlock_destroy(&lock);
+}
+
+Odin::Odin(){
+	pthread_mutex_init(&lock, nullptr);
+	pthread_cond_init(&loadCondition, nullptr);
+}
+
+Odin::~Odin(){
+	shutdown();
+
+	for (auto &factory : typeToFactoryMap){
+		delete factory.second;
+	}
+
+	for (auto &page : pages){
+		Slot* slots = page.load(std::memory_order_relaxed);
+		if (!slots) continue;
+
+		for (uint32_t i=0; i<PAGE_SIZE; i++){
+			slots[i].~Slot();
+		}
+		Horreum::free(slots);
+	}
+
+	pthread_cond_destroy(&loadCondition);
+	pthread_mutex_destroy(&lock);
+}
+
+Odin& Odin::getInstance(){
+	static Odin instance;
+	return instance;
+}
+
+void Odin::initialize(uint32_t loaderThreadCount){
+	Odin &instance = getInstance();
+	if (!instance.loaders) instance.loaders = new WorkerPool(loaderThreadCount);
+}
+
+void Odin::shutdown(){
+	Odin &instance = getInstance();
+	unwatch();
+	clear();
+
+	delete instance.loaders;
+	instance.loaders = nullptr;
+
+	// no asset can use the mapped payloads anymore
+	pthread_mutex_lock(&instance.lock);
+	for (Pack* pack : instance.packs){
+		delete pack;
+	}
+	instance.packs.clear();
+	pthread_mutex_unlock(&instance.lock);
+}
+
+void Odin::mountPack(const char* path){
+	Odin &instance = getInstance();
+	Pack* pack = new Pack(path);
+
+	pthread_mutex_lock(&instance.lock);
+	instance.packs.push_back(pack);
+	pthread_mutex_unlock(&instance.lock);
+}
+
+bool Odin::findInPacks(AssetID id, Span &span){
+	Odin &instance = getInstance();
+	bool found = false;
+
+	pthread_mutex_lock(&instance.lock);
+	for (auto it = instance.packs.rbegin(); it != instance.packs.rend() && !found; it++){
+		const PackEntry* entry = (*it)->find(id);
+		if (entry){
+			span = {(*it)->getData(*entry), static_cast<size_t>(entry->size), entry->type};
+			found = true;
+		}
+	}
+	pthread_mutex_unlock(&instance.lock);
+	return found;
+}
+
+void Odin::registerFactoryPtr(Factory* factory){
+	Odin &instance = getInstance();
+	pthread_mutex_lock(&instance.lock);
+	instance.typeToFactoryMap[factory->getTypeHash()] = factory;
+	pthread_mutex_unlock(&instance.lock);
+}
+
+Odin::Factory* Odin::getTypeFactory(size_t hashCode){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	auto it = instance.typeToFactoryMap.find(hashCode);
+	Factory* factory = it == instance.typeToFactoryMap.end() ? nullptr : it->second;
+	pthread_mutex_unlock(&instance.lock);
+	return factory;
+}
+
+Odin::Slot& Odin::getSlot(Handle handle){
+	uint32_t index = handle & INDEX_MASK;
+	return getInstance().pages[index >> PAGE_SHIFT].load(std::memory_order_acquire)[index & PAGE_MASK];
+}
+
+uint32_t Odin::allocateSlot(){
+	if (freeSlots != NO_SLOT){
+		uint32_t index = freeSlots;
+		freeSlots = getSlot(index).nextFree;
+		return index;
+	}
+
+	if (slotCount > INDEX_MASK) return NO_SLOT;
+
+	// a new page, the slots of the previous ones are never moved
+	uint32_t index = slotCount++;
+	auto &page = pages[index >> PAGE_SHIFT];
+	if (!page.load(std::memory_order_relaxed)){
+		Slot* slots = static_cast<Slot*>(Horreum::malloc(sizeof(Slot) * PAGE_SIZE, Horreum::Category::Assets));
+		assert(slots && "MALLOC ERROR");
+
+		for (uint32_t i=0; i<PAGE_SIZE; i++){
+			new (&slots[i]) Slot();
+		}
+		page.store(slots, std::memory_order_release);
+	}
+	return index;
+}
+
+void Odin::freeSlot(uint32_t index){
+	Slot &slot = getSlot(index);
+	uncache(index);
+
+	// the dependencies are kept until the asset is destroyed
+	void* asset = slot.assetPtr.load(std::memory_order_relaxed);
+	if (asset || slot.dependencies) deadAssets.push_back({asset, slot.hashCode, slot.dependencies});
+	slot.dependencies = nullptr;
+
+	if (slot.name) Horreum::free(slot.name);
+	slot.name = nullptr;
+	delete slot.data;
+	slot.data = nullptr;
+	slot.assetPtr.store(nullptr, std::memory_order_relaxed);
+	slot.state.store(AssetState::Unloaded, std::memory_order_relaxed);
+	slot.size = 0;
+
+	// the handles to the previous asset stop resolving
+	uint32_t generation = (slot.generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK;
+	slot.generation.store(generation ? generation : 1, std::memory_order_release);
+
+	slot.nextFree = freeSlots;
+	freeSlots = index;
+}
+
+Odin::Handle Odin::retainExisting(AssetID id, const char* name){
+	Odin &instance = getInstance();
+	Shard &shard = instance.shards[getShardIndex(id)];
+	Handle handle = INVALID_HANDLE;
+
+	pthread_rwlock_rdlock(&shard.lock);
+	auto it = shard.slots.find(id);
+	if (it != shard.slots.end()){
+		Slot &slot = getSlot(it->second);
+		assert((!name || !slot.name || strcmp(name, slot.name) == 0) && "asset name hash collision");
+
+		// a cached asset, the read lock keeps the last reference from being dropped again meanwhile
+		if (slot.refCount.fetch_add(1, std::memory_order_relaxed) == 0){
+			pthread_mutex_lock(&instance.lock);
+			instance.uncache(it->second);
+			pthread_mutex_unlock(&instance.lock);
+		}
+		handle = (slot.generation.load(std::memory_order_relaxed) << INDEX_BITS) | it->second;
+	}
+	pthread_rwlock_unlock(&shard.lock);
+	return handle;
+}
+
+Odin::Handle Odin::findOrInsert(AssetID id, const char* name, size_t typeID, const Data &data, bool &inserted){
+	Odin &instance = getInstance();
+	Shard &shard = instance.shards[getShardIndex(id)];
+	inserted = false;
+
+	Handle handle = retainExisting(id, name);
+	if (handle) return handle;
+
+	// an other thread may insert it between the two locks
+	pthread_rwlock_wrlock(&shard.lock);
+	auto result = shard.slots.try_emplace(id, NO_SLOT);
+
+	if (result.second){
+		pthread_mutex_lock(&instance.lock);
+		uint32_t index = instance.allocateSlot();
+		if (index != NO_SLOT) getSlot(index).data = new Data(data);
+		pthread_mutex_unlock(&instance.lock);
+
+		if (index == NO_SLOT){
+			shard.slots.erase(result.first);
+			pthread_rwlock_unlock(&shard.lock);
+			throw "too many assets";
+		}
+
+		Slot &slot = getSlot(index);
+		slot.id = id;
+		slot.hashCode = typeID;
+		slot.shard = getShardIndex(id);
+		slot.state.store(AssetState::Pending, std::memory_order_relaxed);
+
+		if (name){
+			size_t size = strlen(name) + 1;
+			slot.name = static_cast<char*>(Horreum::malloc(size, Horreum::Category::Assets));
+			memcpy(slot.name, name, size);
+		}
+
+		result.first->second = index;
+		inserted = true;
+	}
+
+	Slot &slot = getSlot(result.first->second);
+	if (slot.refCount.fetch_add(1, std::memory_order_relaxed) == 0){
+		pthread_mutex_lock(&instance.lock);
+		instance.uncache(result.first->second);
+		pthread_mutex_unlock(&instance.lock);
+	}
+	handle = (slot.generation.load(std::memory_order_relaxed) << INDEX_BITS) | result.first->second;
+	pthread_rwlock_unlock(&shard.lock);
+	return handle;
+}
+
+bool Odin::restartFailed(Slot &slot, const Data &data){
+	if (slot.state.load(std::memory_order_acquire) != AssetState::Failed) return false;
+
+	Odin &instance = getInstance();
+	bool restarted = false;
+
+	// the states change under the lock, only one of the requests racing on the slot restarts it
+	pthread_mutex_lock(&instance.lock);
+	if (slot.state.load(std::memory_order_relaxed) == AssetState::Failed){
+		// the dependencies of the failed load are released by the next update, the new load acquires its own
+		if (slot.dependencies) instance.deadAssets.push_back({nullptr, slot.hashCode, slot.dependencies});
+		slot.dependencies = nullptr;
+
+		delete slot.data;
+		slot.data = new Data(data);
+		slot.state.store(AssetState::Pending, std::memory_order_relaxed);
+		restarted = true;
+	}
+	pthread_mutex_unlock(&instance.lock);
+	return restarted;
+}
+
+void* Odin::create(Factory* factory, AssetID id, const Data &data, bool fromPacks){
+	Horreum::CategoryScope category(Horreum::Category::Assets);
+
+	Span span;
+	bool packed = fromPacks && findInPacks(id, span);
+
+	try {
+		return packed ? factory->createFromPack(span, data) : factory->create(data);
+	} catch (const char*){
+		return nullptr;
+	}
+}
+
+void Odin::endLoad(Handle handle, void* ptr, size_t size){
+	Odin &instance = getInstance();
+	Slot &slot = getSlot(handle);
+
+	std::vector<LoadRequest*> ready;
+
+	pthread_mutex_lock(&instance.lock);
+	slot.size = size;
+	slot.assetPtr.store(ptr, std::memory_order_release);
+	slot.state.store(ptr ? AssetState::Loaded : AssetState::Failed, std::memory_order_release);
+
+	// the loads depending on this asset, the last dependency to end schedules the load
+	auto &dependents = instance.dependentLoads;
+	for (size_t i=0; i<dependents.size();){
+		if (dependents[i].dependency == handle){
+			LoadRequest* request = dependents[i].request;
+			if (!ptr) request->dependencyFailed.store(true, std::memory_order_relaxed);
+			if (request->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) ready.push_back(request);
+
+			dependents[i] = dependents.back();
+			dependents.pop_back();
+		} else {
+			i++;
+		}
+	}
+
+	// the requests made while the asset was loading end with this one
+	auto &waiting = instance.waitingLoads;
+	for (size_t i=0; i<waiting.size();){
+		if (waiting[i]->handle == handle){
+			instance.completedLoads.push_back(waiting[i]);
+			waiting[i] = waiting.back();
+			waiting.pop_back();
+		} else {
+			i++;
+		}
+	}
+
+	pthread_cond_broadcast(&instance.loadCondition);
+	pthread_mutex_unlock(&instance.lock);
+
+	for (LoadRequest* request : ready){
+		scheduleLoad(request);
+	}
+}
+
+void Odin::waitLoad(Slot &slot){
+	if (slot.state.load(std::memory_order_acquire) != AssetState::Pending) return;
+
+	Odin &instance = getInstance();
+	pthread_mutex_lock(&instance.lock);
+	while (slot.state.load(std::memory_order_acquire) == AssetState::Pending){
+		// a waiting loader thread could hold the only loader the load needs, it runs the queued loads meanwhile
+		LoadRequest* request = inLoader ? instance.popLoad() : nullptr;
+		if (request){
+			pthread_mutex_unlock(&instance.lock);
+			runLoad(request);
+			pthread_mutex_lock(&instance.lock);
+		} else {
+			pthread_cond_wait(&instance.loadCondition, &instance.lock);
+		}
+	}
+	pthread_mutex_unlock(&instance.lock);
+}
+
+void Odin::runLoad(void* data){
+	LoadRequest* request = static_cast<LoadRequest*>(data);
+	Odin &instance = getInstance();
+	Slot &slot = getSlot(request->handle);
+
+	// the load can no longer be reprioritized nor cancelled
+	pthread_mutex_lock(&instance.lock);
+	slot.load = nullptr;
+	bool cancelled = request->cancelled;
+	pthread_mutex_unlock(&instance.lock);
+
+	// a failed dependency fails the asset, without calling the factory
+	void* asset = nullptr;
+	if (!cancelled && !request->dependencyFailed.load(std::memory_order_acquire)){
+		asset = create(request->factory, slot.id, request->data);
+	}
+	size_t size = asset ? request->factory->getSize(asset) : 0;
+	endLoad(request->handle, asset, size);
+
+	pthread_mutex_lock(&instance.lock);
+	instance.frameBytes += size;
+	instance.completedLoads.push_back(request);
+	pthread_mutex_unlock(&instance.lock);
+}
+
+void Odin::scheduleLoad(LoadRequest* request){
+	Odin &instance = getInstance();
+
+	if (!instance.loaders){
+		runLoad(request);
+		return;
+	}
+
+	// the queue is read when a loader thread is free, so the priority can still change meanwhile
+	pthread_mutex_lock(&instance.lock);
+	instance.queuedLoads[static_cast<uint32_t>(request->priority)].push_back(request);
+	request->queued = true;
+
+	// every loader is busy, wake the ones waiting for a load so they can run it
+	bool submit = instance.loadTasks < instance.loaders->getThreadCount();
+	if (submit) instance.loadTasks++;
+	else pthread_cond_broadcast(&instance.loadCondition);
+	pthread_mutex_unlock(&instance.lock);
+
+	if (submit) instance.loaders->submit(&Odin::runLoads, nullptr, &instance.loadGroup);
+}
+
+size_t Odin::getQueuedLoadCount() const{
+	size_t count = 0;
+	for (const auto &queue : queuedLoads){
+		count += queue.size();
+	}
+	return count;
+}
+
+Odin::LoadRequest* Odin::popLoad(){
+	for (uint32_t i=0; i<PRIORITY_COUNT; i++){
+		auto &queue = queuedLoads[i];
+		if (queue.empty()) continue;
+
+		// the budget of the frame is spent, the next update starts the remaining loads
+		bool spent = frameByteBudget && frameBytes >= frameByteBudget;
+		if (spent && i != static_cast<uint32_t>(Priority::Critical)) break;
+
+		LoadRequest* request = queue.front();
+		queue.pop_front();
+		request->queued = false;
+		return request;
+	}
+	return nullptr;
+}
+
+void Odin::runLoads(void*){
+	Odin &instance = getInstance();
+
+	inLoader = true;
+	while (true){
+		pthread_mutex_lock(&instance.lock);
+		LoadRequest* request = instance.popLoad();
+
+		// checked and counted under the lock, so a load queued meanwhile submits a new task
+		if (!request) instance.loadTasks--;
+		pthread_mutex_unlock(&instance.lock);
+
+		if (!request) break;
+		runLoad(request);
+	}
+	inLoader = false;
+}
+
+void Odin::dispatchLoads(){
+	Odin &instance = getInstance();
+	if (!instance.loaders) return;
+
+	pthread_mutex_lock(&instance.lock);
+	uint32_t threadCount = instance.loaders->getThreadCount();
+	size_t count = std::min<size_t>(instance.loadTasks < threadCount ? threadCount - instance.loadTasks : 0, instance.getQueuedLoadCount());
+	instance.loadTasks += static_cast<uint32_t>(count);
+	pthread_mutex_unlock(&instance.lock);
+
+	for (size_t i=0; i<count; i++){
+		instance.loaders->submit(&Odin::runLoads, nullptr, &instance.loadGroup);
+	}
+}
+
+bool Odin::setPriority(Handle handle, Priority priority, bool raiseOnly){
+	Odin &instance = getInstance();
+	Slot &slot = getSlot(handle);
+	std::vector<Handle> dependencies;
+	bool requeued = false;
+
+	pthread_mutex_lock(&instance.lock);
+	LoadRequest* request = slot.load;
+	if (request && !(raiseOnly && request->priority <= priority)){
+		if (request->queued){
+			auto &queue = instance.queuedLoads[static_cast<uint32_t>(request->priority)];
+			queue.erase(std::find(queue.begin(), queue.end(), request));
+			instance.queuedLoads[static_cast<uint32_t>(priority)].push_back(request);
+			requeued = true;
+
+			// a critical load is started past the frame budget, the loader threads waiting for a load can take it
+			pthread_cond_broadcast(&instance.loadCondition);
+		}
+
+		// a lowered asset keeps its dependencies, other assets may need them sooner
+		if (priority < request->priority && slot.dependencies) dependencies = *slot.dependencies;
+		request->priority = priority;
+	}
+	pthread_mutex_unlock(&instance.lock);
+
+	// the asset holds its dependencies, the cycles are not supported
+	for (Handle dependency : dependencies){
+		setPriority(dependency, priority, true);
+	}
+
+	// the loader tasks may have stopped on the spent budget
+	if (requeued) dispatchLoads();
+	return request != nullptr;
+}
+
+bool Odin::cancel(Handle handle){
+	Odin &instance = getInstance();
+	Slot &slot = getSlot(handle);
+	bool queued = false;
+
+	// a load waiting for its dependencies ends as failed once they end
+	pthread_mutex_lock(&instance.lock);
+	LoadRequest* request = slot.load;
+	if (request){
+		request->cancelled = true;
+
+		if (request->queued){
+			auto &queue = instance.queuedLoads[static_cast<uint32_t>(request->priority)];
+			queue.erase(std::find(queue.begin(), queue.end(), request));
+			request->queued = false;
+			queued = true;
+		}
+	}
+	pthread_mutex_unlock(&instance.lock);
+
+	// ended at once, without calling the factory
+	if (queued) runLoad(request);
+	return request != nullptr;
+}
+
+void Odin::startLoad(LoadRequest* request, Dependencies &dependencies){
+	Odin &instance = getInstance();
+	Slot &slot = getSlot(request->handle);
+
+	pthread_mutex_lock(&instance.lock);
+	slot.load = request;
+	Priority priority = request->priority;
+	pthread_mutex_unlock(&instance.lock);
+
+	// the extra count keeps the load from starting before every dependency is requested
+	request->pendingDependencies.store(static_cast<uint32_t>(dependencies.list.size()) + 1, std::memory_order_relaxed);
+	std::vector<Handle>* handles = dependencies.list.empty() ? nullptr : new std::vector<Handle>();
+	uint32_t ended = 0;
+
+	for (const Dependencies::Dependency &dependency : dependencies.list){
+		// an asset depending on itself would wait for itself
+		AssetID id = hashName(dependency.name.c_str());
+		if (id == slot.id){
+			ended++;
+			continue;
+		}
+
+		// the dependencies are loaded in parallel on the loader threads, the asset holds a reference to each of them
+		Handle handle = INVALID_HANDLE;
+		try {
+			handle = acquireAsync(id, dependency.name.c_str(), dependency.typeID, dependency.data, nullptr, nullptr, priority);
+		} catch (const char*){}
+
+		if (!handle){
+			request->dependencyFailed.store(true, std::memory_order_relaxed);
+			ended++;
+			continue;
+		}
+		handles->push_back(handle);
+
+		// endLoad changes the state under the lock, so the dependency cannot end between the check and the push
+		pthread_mutex_lock(&instance.lock);
+		AssetState state = getSlot(handle).state.load(std::memory_order_relaxed);
+		if (state == AssetState::Pending){
+			instance.dependentLoads.push_back({handle, request});
+		} else {
+			if (state == AssetState::Failed) request->dependencyFailed.store(true, std::memory_order_relaxed);
+			ended++;
+		}
+		pthread_mutex_unlock(&instance.lock);
+	}
+
+	pthread_mutex_lock(&instance.lock);
+	slot.dependencies = handles;
+	pthread_mutex_unlock(&instance.lock);
+
+	if (request->pendingDependencies.fetch_sub(ended + 1, std::memory_order_acq_rel) == ended + 1) scheduleLoad(request);
+}
+
+Odin::Handle Odin::acquire(AssetID id, const char* name, size_t typeID, const Data &data){
+	bool inserted;
+	Handle handle = findOrInsert(id, name, typeID, data, inserted);
+	Slot &slot = getSlot(handle);
+
+	if (inserted || restartFailed(slot, data)){
+		Factory* factory = getTypeFactory(typeID);
+		if (!factory){
+			endLoad(handle, nullptr, 0);
+			release(slot);
+			throw "factory not registred for this type of asset";
+		}
+
+		Dependencies dependencies;
+		factory->getDependencies(data, dependencies);
+
+		if (dependencies.list.empty()){
+			// the factory works without any lock, the other threads wait on the pending slot only if they want this asset
+			void* asset = create(factory, id, data);
+			endLoad(handle, asset, asset ? factory->getSize(asset) : 0);
+		} else {
+			// the dependencies load on the loader threads, then the asset, this thread only waits for the result
+			retain(slot);
+			startLoad(new LoadRequest{handle, factory, data, nullptr, nullptr, Priority::Critical}, dependencies);
+			waitLoad(slot);
+		}
+	} else {
+		// a queued load is needed now
+		if (slot.state.load(std::memory_order_acquire) == AssetState::Pending) setPriority(handle, Priority::Critical, true);
+		waitLoad(slot);
+	}
+
+	if (slot.state.load(std::memory_order_acquire) == AssetState::Failed){
+		release(slot);
+		throw "failed to load the asset";
+	}
+	return handle;
+}
+
+Odin::Handle Odin::acquireAsync(AssetID id, const char* name, size_t typeID, const Data &data, LoadCallback callback, void* userData, Priority priority){
+	Odin &instance = getInstance();
+
+	bool inserted;
+	Handle handle = findOrInsert(id, name, typeID, data, inserted);
+	Slot &slot = getSlot(handle);
+	Factory* factory = getTypeFactory(typeID);
+
+	// a failed or cancelled asset is loaded again, as a new one
+	if (!inserted) inserted = restartFailed(slot, data);
+
+	if (inserted && !factory){
+		endLoad(handle, nullptr, 0);
+		release(slot);
+		throw "factory not registred for this type of asset";
+	}
+
+	// the request holds a reference, so the slot outlives the load and the callback
+	LoadRequest* request = nullptr;
+	if (inserted || callback){
+		retain(slot);
+		request = new LoadRequest{handle, factory, data, callback, userData, priority};
+	}
+
+	if (inserted){
+		Dependencies dependencies;
+		factory->getDependencies(data, dependencies);
+		startLoad(request, dependencies);
+	} else if (request){
+		pthread_mutex_lock(&instance.lock);
+		if (slot.state.load(std::memory_order_relaxed) == AssetState::Pending){
+			instance.waitingLoads.push_back(request);
+		} else {
+			instance.completedLoads.push_back(request);
+		}
+		pthread_mutex_unlock(&instance.lock);
+	}
+
+	if (!inserted && slot.state.load(std::memory_order_acquire) == AssetState::Pending) setPriority(handle, priority, true);
+	return handle;
+}
+
+void Odin::update(){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	std::vector<LoadRequest*> completed;
+	completed.swap(instance.completedLoads);
+	uint32_t timeBudget = instance.frameTimeBudget;
+	instance.frameBytes = 0;
+	pthread_mutex_unlock(&instance.lock);
+
+	// a new frame, the loads held back by the budget of the previous one start
+	dispatchLoads();
+
+	// the critical loads first, they are never held back
+	std::stable_sort(completed.begin(), completed.end(), [](const LoadRequest* a, const LoadRequest* b){return a->priority < b->priority;});
+	auto start = std::chrono::steady_clock::now();
+
+	size_t finished = 0;
+	for (; finished<completed.size(); finished++){
+		LoadRequest* request = completed[finished];
+		if (timeBudget && request->priority != Priority::Critical && std::chrono::steady_clock::now() - start >= std::chrono::microseconds(timeBudget)) break;
+
+		Slot &slot = getSlot(request->handle);
+
+		if (request->callback){
+			bool loaded = slot.state.load(std::memory_order_acquire) == AssetState::Loaded;
+			request->callback(slot.name, loaded ? slot.assetPtr.load(std::memory_order_acquire) : nullptr, loaded, request->userData);
+		}
+
+		release(slot);
+		delete request;
+	}
+
+	// the remaining loads are finished by the next updates, before the newer ones
+	if (finished < completed.size()){
+		pthread_mutex_lock(&instance.lock);
+		instance.completedLoads.insert(instance.completedLoads.begin(), completed.begin() + finished, completed.end());
+		pthread_mutex_unlock(&instance.lock);
+	}
+
+	// the released assets are destroyed here, so the factories only ever destroy on the main thread
+	pthread_mutex_lock(&instance.lock);
+	std::vector<DeadAsset> dead;
+	dead.swap(instance.deadAssets);
+	std::vector<Reload> reloads;
+	reloads.swap(instance.completedReloads);
+	pthread_mutex_unlock(&instance.lock);
+
+	// the dependencies released by the destroyed assets are destroyed in the same update
+	while (!dead.empty()){
+		destroy(dead);
+		dead.clear();
+
+		pthread_mutex_lock(&instance.lock);
+		dead.swap(instance.deadAssets);
+		pthread_mutex_unlock(&instance.lock);
+	}
+
+	// the hot reloaded assets replace the previous ones at once for every reference
+	// the previous ones are destroyed by the next update, so the pointers taken during this frame stay valid
+	for (const Reload &reload : reloads){
+		Slot &slot = getSlot(reload.handle);
+
+		if (reload.asset){
+			pthread_mutex_lock(&instance.lock);
+			void* previous = slot.assetPtr.exchange(reload.asset, std::memory_order_acq_rel);
+			slot.size = reload.size;
+			if (previous) instance.deadAssets.push_back({previous, slot.hashCode, nullptr});
+			pthread_mutex_unlock(&instance.lock);
+		}
+
+		release(slot);
+	}
+}
+
+void Odin::watch(const char* root, uint32_t debounceMilliseconds){
+	Odin &instance = getInstance();
+	unwatch();
+	instance.watcher = new FileWatcher(root, debounceMilliseconds, &Odin::onFileChanged, nullptr);
+	instance.watchRoot = root;
+	instance.watchDebounce = debounceMilliseconds;
+}
+
+void Odin::unwatch(){
+	Odin &instance = getInstance();
+	delete instance.watcher;
+	instance.watcher = nullptr;
+}
+
+void Odin::onFileChanged(const char* path, void*){
+	Odin &instance = getInstance();
+
+	// only the loaded assets are reloaded, the reference keeps the slot until update swaps the asset
+	Handle handle = retainExisting(hashName(path), path);
+	if (!handle) return;
+
+	if (getSlot(handle).state.load(std::memory_order_acquire) != AssetState::Loaded){
+		release(getSlot(handle));
+		return;
+	}
+
+	void* data = reinterpret_cast<void*>(static_cast<uintptr_t>(handle));
+	if (instance.loaders){
+		instance.loaders->submit(&Odin::runReload, data, &instance.loadGroup);
+	} else {
+		runReload(data);
+	}
+}
+
+void Odin::runReload(void* data){
+	Odin &instance = getInstance();
+	Handle handle = static_cast<Handle>(reinterpret_cast<uintptr_t>(data));
+	Slot &slot = getSlot(handle);
+
+	pthread_mutex_lock(&instance.lock);
+	Data* loadData = slot.data ? new Data(*slot.data) : nullptr;
+	pthread_mutex_unlock(&instance.lock);
+
+	Factory* factory = getTypeFactory(slot.hashCode);
+	inLoader = true;
+	void* asset = factory && loadData ? create(factory, slot.id, *loadData, false) : nullptr;
+	inLoader = false;
+	delete loadData;
+
+	// a failed reload keeps the previous asset
+	pthread_mutex_lock(&instance.lock);
+	instance.completedReloads.push_back({handle, asset, asset ? factory->getSize(asset) : 0});
+	pthread_mutex_unlock(&instance.lock);
+}
+
+void Odin::retain(Slot &slot){
+	// the caller already holds a reference, the count cannot be zero
+	slot.refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Odin::release(Slot &slot){
+	auto &refCount = slot.refCount;
+
+	// not the last reference, no lock
+	// release, the writes made through this reference happen before the destruction of the asset
+	uint32_t count = refCount.load(std::memory_order_relaxed);
+	while (count > 1){
+		if (refCount.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) return;
+	}
+
+	// the last reference is dropped under the write lock, so no hit can take the count back from zero meanwhile
+	Odin &instance = getInstance();
+	Shard &shard = instance.shards[slot.shard];
+
+	bool overBudget = false;
+
+	pthread_rwlock_wrlock(&shard.lock);
+	if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1){
+		auto it = shard.slots.find(slot.id);
+		pthread_mutex_lock(&instance.lock);
+
+		// the loaded assets with a size stay in the cache, a hit takes them back without loading
+		if (instance.cacheBudget && slot.size && slot.state.load(std::memory_order_relaxed) == AssetState::Loaded){
+			instance.cache(it->second);
+			overBudget = instance.cacheSize > instance.cacheBudget;
+		} else {
+			instance.freeSlot(it->second);
+			shard.slots.erase(it);
+		}
+
+		pthread_mutex_unlock(&instance.lock);
+	}
+	pthread_rwlock_unlock(&shard.lock);
+
+	// the victims may be in any shard, they are evicted once this one is unlocked
+	if (overBudget) evict();
+}
+
+void Odin::cache(uint32_t index){
+	Slot &slot = getSlot(index);
+
+	if (slot.cached){
+		uncache(index);
+	}
+
+	slot.cached = true;
+	slot.lruPrev = lruTail;
+	slot.lruNext = NO_SLOT;
+
+	if (lruTail != NO_SLOT){
+		getSlot(lruTail).lruNext = index;
+	} else {
+		lruHead = index;
+	}
+	lruTail = index;
+	cacheSize += slot.size;
+}
+
+void Odin::uncache(uint32_t index){
+	Slot &slot = getSlot(index);
+	if (!slot.cached) return;
+
+	if (slot.lruPrev != NO_SLOT){
+		getSlot(slot.lruPrev).lruNext = slot.lruNext;
+	} else {
+		lruHead = slot.lruNext;
+	}
+
+	if (slot.lruNext != NO_SLOT){
+		getSlot(slot.lruNext).lruPrev = slot.lruPrev;
+	} else {
+		lruTail = slot.lruPrev;
+	}
+
+	slot.cached = false;
+	slot.lruPrev = NO_SLOT;
+	slot.lruNext = NO_SLOT;
+	cacheSize -= slot.size;
+}
+
+void Odin::evict(){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	while (instance.cacheSize > instance.cacheBudget && instance.lruHead != NO_SLOT){
+		uint32_t index = instance.lruHead;
+		Slot &slot = getSlot(index);
+		AssetID id = slot.id;
+		Shard &shard = instance.shards[slot.shard];
+
+		// the shard lock is taken before the lock, the victim is checked again once both are held
+		pthread_mutex_unlock(&instance.lock);
+		pthread_rwlock_wrlock(&shard.lock);
+		pthread_mutex_lock(&instance.lock);
+
+		if (slot.cached && slot.id == id && slot.refCount.load(std::memory_order_relaxed) == 0){
+			instance.freeSlot(index);
+			shard.slots.erase(id);
+		}
+		pthread_rwlock_unlock(&shard.lock);
+	}
+	pthread_mutex_unlock(&instance.lock);
+}
+
+void Odin::setCacheBudget(size_t bytes){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	instance.cacheBudget = bytes;
+	bool overBudget = instance.cacheSize > bytes;
+	pthread_mutex_unlock(&instance.lock);
+
+	if (overBudget) evict();
+}
+
+size_t Odin::getCacheSize(){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	size_t size = instance.cacheSize;
+	pthread_mutex_unlock(&instance.lock);
+	return size;
+}
+
+void* Odin::getAssetPtr(Handle handle){
+	uint32_t index = handle & INDEX_MASK;
+	Slot* page = getInstance().pages[index >> PAGE_SHIFT].load(std::memory_order_acquire);
+	if (!page) return nullptr;
+
+	Slot &slot = page[index & PAGE_MASK];
+	uint32_t generation = handle >> INDEX_BITS;
+	if (slot.generation.load(std::memory_order_acquire) != generation) return nullptr;
+
+	// the slot may be freed and reused meanwhile, the pointer is only the one of the handle if the generation did not change
+	void* asset = slot.assetPtr.load(std::memory_order_acquire);
+	if (slot.generation.load(std::memory_order_acquire) != generation) return nullptr;
+	return asset;
+}
+
+Odin::Handle Odin::acquireHandle(const char* name, size_t typeID, const Data &data){
+	return acquire(hashName(name), name, typeID, data);
+}
+
+void Odin::retainHandle(Handle handle){
+	retain(getSlot(handle));
+}
+
+void Odin::releaseHandle(Handle handle){
+	release(getSlot(handle));
+}
+
+Odin::Handle Odin::acquireHandleAsync(const char* name, size_t typeID, const Data &data, LoadCallback callback, void* userData, Priority priority){
+	return acquireAsync(hashName(name), name, typeID, data, callback, userData, priority);
+}
+
+bool Odin::setLoadPriority(const char* name, Priority priority){
+	return setLoadPriority(hashName(name), priority);
+}
+
+bool Odin::setLoadPriority(AssetID id, Priority priority){
+	// the reference keeps the slot while the request is looked up
+	Handle handle = retainExisting(id, nullptr);
+	if (!handle) return false;
+
+	bool pending = setPriority(handle, priority, false);
+	release(getSlot(handle));
+	return pending;
+}
+
+bool Odin::cancelLoad(const char* name){
+	return cancelLoad(hashName(name));
+}
+
+bool Odin::cancelLoad(AssetID id){
+	Handle handle = retainExisting(id, nullptr);
+	if (!handle) return false;
+
+	bool pending = cancel(handle);
+	release(getSlot(handle));
+	return pending;
+}
+
+void Odin::setFrameBudget(size_t bytes, uint32_t microseconds){
+	Odin &instance = getInstance();
+
+	pthread_mutex_lock(&instance.lock);
+	instance.frameByteBudget = bytes;
+	instance.frameTimeBudget = microseconds;
+	pthread_mutex_unlock(&instance.lock);
+
+	// a larger budget may start the loads held back
+	dispatchLoads();
+}
+
+Odin::AssetState Odin::getAssetState(const char* name){
+	return getAssetState(hashName(name));
+}
+
+Odin::AssetState Odin::getAssetState(AssetID id){
+	Shard &shard = getInstance().shards[getShardIndex(id)];
+
+	pthread_rwlock_rdlock(&shard.lock);
+	auto it = shard.slots.find(id);
+	AssetState state = it == shard.slots.end() ? AssetState::Unloaded : getSlot(it->second).state.load(std::memory_order_relaxed);
+	pthread_rwlock_unlock(&shard.lock);
+	return state;
+}
+
+void Odin::reloadPtr(AssetID id, const char* name, size_t typeID, const Data &data){
+	Odin &instance = getInstance();
+
+	Factory* factory = getTypeFactory(typeID);
+	if (!factory) throw "factory not registred for this type of asset";
+
+	void* ptr = create(factory, id, data);
+	if (!ptr) throw "failed to reload the asset";
+
+	// a load in flight would overwrite the new asset, the reference keeps the slot while waiting
+	bool inserted;
+	Handle handle = findOrInsert(id, name, typeID, data, inserted);
+	Slot &slot = getSlot(handle);
+	if (!inserted) waitLoad(slot);
+
+	Shard &shard = instance.shards[slot.shard];
+	pthread_rwlock_wrlock(&shard.lock);
+	DeadAsset previous = {slot.assetPtr.load(std::memory_order_relaxed), slot.hashCode, nullptr};
+	slot.hashCode = typeID;
+	pthread_rwlock_unlock(&shard.lock);
+
+	endLoad(handle, ptr, factory->getSize(ptr));
+
+	// the previous asset may still be used through a pointer taken before, it is destroyed by the next update
+	// the next hot reloads use the new data
+	pthread_mutex_lock(&instance.lock);
+	if (previous.asset) instance.deadAssets.push_back(previous);
+	delete slot.data;
+	slot.data = new Data(data);
+	pthread_mutex_unlock(&instance.lock);
+
+	// a new slot keeps the reference and stays until clear, as the loaded ones
+	// an existing one goes back to the cache or is freed with its last reference
+	if (!inserted) release(slot);
+}
+
+void Odin::destroy(const std::vector<DeadAsset> &dead, bool releaseDependencies){
+	for (const DeadAsset &asset : dead){
+		Factory* factory = asset.asset ? getTypeFactory(asset.hashCode) : nullptr;
+		if (factory) factory->destroy(asset.asset);
+
+		// an asset is destroyed before its dependencies
+		if (asset.dependencies && releaseDependencies){
+			for (Handle handle : *asset.dependencies){
+				release(getSlot(handle));
+			}
+		}
+		delete asset.dependencies;
+	}
+}
+
+void Odin::clear(){
+	Odin &instance = getInstance();
+
+	// no reload can start while the slots are freed, the watcher is restarted after
+	bool watching = instance.watcher != nullptr;
+	unwatch();
+
+	// the loads held back by the frame budget are run too
+	pthread_mutex_lock(&instance.lock);
+	size_t byteBudget = instance.frameByteBudget;
+	uint32_t timeBudget = instance.frameTimeBudget;
+	instance.frameByteBudget = 0;
+	instance.frameTimeBudget = 0;
+	pthread_mutex_unlock(&instance.lock);
+	dispatchLoads();
+
+	// let the loads in flight end and drop the references of their requests
+	if (instance.loaders) instance.loaders->wait(instance.loadGroup);
+	update();
+
+	for (Shard &shard : instance.shards){
+		pthread_rwlock_wrlock(&shard.lock);
+		pthread_mutex_lock(&instance.lock);
+		for (auto &it : shard.slots){
+			getSlot(it.second).refCount.store(0, std::memory_order_relaxed);
+			instance.freeSlot(it.second);
+		}
+		pthread_mutex_unlock(&instance.lock);
+
+		shard.slots.clear();
+		pthread_rwlock_unlock(&shard.lock);
+	}
+
+	pthread_mutex_lock(&instance.lock);
+	std::vector<DeadAsset> dead;
+	dead.swap(instance.deadAssets);
+	pthread_mutex_unlock(&instance.lock);
+
+	// every slot is already freed, the dependencies are not released
+	destroy(dead, false);
+
+	pthread_mutex_lock(&instance.lock);
+	instance.frameByteBudget = byteBudget;
+	instance.frameTimeBudget = timeBudget;
+	pthread_mutex_unlock(&instance.lock);
+
+	if (watching){
+		std::string root = instance.watchRoot;
+		watch(root.c_str(), instance.watchDebounce);
+	}
+}
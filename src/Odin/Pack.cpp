@@ -0,0 +1,108 @@
+#include "odin/Pack.hpp"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+Pack::Pack(const char* path){
+	#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE){
+			file = nullptr;
+			throw "failed to open the pack";
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+			unmap();
+			throw "failed to open the pack";
+		}
+		size = static_cast<size_t>(fileSize.QuadPart);
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	#else
+		int file = open(path, O_RDONLY);
+		if (file < 0) throw "failed to open the pack";
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0){
+			close(file);
+			throw "failed to open the pack";
+		}
+		size = static_cast<size_t>(info.st_size);
+
+		// the mapping keeps its own reference to the file
+		void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		data = ptr == MAP_FAILED ? nullptr : static_cast<const char*>(ptr);
+	#endif
+
+	if (!data){
+		unmap();
+		throw "failed to map the pack";
+	}
+
+	// the table of contents and the payloads are checked once, the lookups trust them
+	const PackHeader &header = this->header();
+	bool valid = size >= sizeof(PackHeader)
+		&& header.magic == PackHeader::MAGIC
+		&& header.version == PackHeader::FORMAT_VERSION
+		&& header.size == size
+		&& header.tocOffset <= size
+		&& header.entryCount <= (size - header.tocOffset) / sizeof(PackEntry);
+
+	if (valid){
+		entries = reinterpret_cast<const PackEntry*>(data + header.tocOffset);
+		for (uint32_t i=0; i<header.entryCount && valid; i++){
+			valid = entries[i].offset <= size && entries[i].size <= size - entries[i].offset
+				&& (i == 0 || entries[i - 1].id < entries[i].id);
+		}
+	}
+
+	if (!valid){
+		unmap();
+		throw "invalid pack";
+	}
+}
+
+Pack::~Pack(){
+	unmap();
+}
+
+void Pack::unmap(){
+	#ifdef _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file) CloseHandle(file);
+		mapping = nullptr;
+		file = nullptr;
+	#else
+		if (data) munmap(const_cast<char*>(data), size);
+	#endif
+
+	data = nullptr;
+	entries = nullptr;
+}
+
+const PackEntry* Pack::find(uint64_t id) const{
+	uint32_t first = 0;
+	uint32_t last = getEntryCount();
+
+	while (first < last){
+		uint32_t middle = first + (last - first) / 2;
+		if (entries[middle].id < id){
+			first = middle + 1;
+		} else {
+			last = middle;
+		}
+	}
+
+	if (first < getEntryCount() && entries[first].id == id) return &entries[first];
+	return nullptr;
+}
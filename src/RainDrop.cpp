@@ -5,6 +5,7 @@
 #include "Hermes.hpp"
 #include "horreum/Horreum.hpp"
 #include "EventManager.hpp"
+#include "WorkerPool.hpp"
 #include "RainDrop.hpp"
 
 #define RD_TRHOW_EXCEPT(what, why) throw RainDrop::Exception(what, __func__, why);
@@ -37,6 +38,13 @@ namespace RainDrop{
 		SDL_Quit();
 	}
 
+	// === events ===
+
+	static double getEngineTime(){
+		static const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+		return static_cast<double>(SDL_GetPerformanceCounter()) / frequency;
+	}
+
 	// === ECS ===
 
 	void initializeECS(){
@@ -59,13 +67,23 @@ namespace RainDrop{
 		Horreum::initialize();
 		Gramophone::initialize();
 		Odin::initialize();
+		instance.workers = new WorkerPool();
 		Hermes::initialize(150, 1500);
+		Hermes::setClock(&getEngineTime);
+		Hermes::setWorkerPool(instance.workers);
 
 		initializeECS();
 		registerEvents();
 	}
 
 	void RD_API shutdown(){
+		Core& instance = getInstance();
+
+		Hermes::setWorkerPool(nullptr);
+		delete instance.workers;
+		instance.workers = nullptr;
+		Odin::shutdown();
+
 		shutdownWindow();
 	}
 
@@ -101,8 +119,12 @@ namespace RainDrop{
 	}
 
 	// events
-	EventID RD_API registerEvent(const char* name, uint32_t dataSize){
-		return Hermes::registerEvent(name, static_cast<uint16_t>(dataSize));
+	EventID RD_API registerEvent(const char* name, uint32_t dataSize, EventCoalescing coalescing, void(*accumulate)(void*, const void*, uint16_t), EventDelivery delivery){
+		return Hermes::registerEvent(name, static_cast<uint16_t>(dataSize), static_cast<Hermes::Coalescing>(coalescing), accumulate, static_cast<Hermes::Delivery>(delivery));
+	}
+
+	EventID RD_API registerEvent(const char* name, uint32_t dataSize, EventDelivery delivery){
+		return Hermes::registerEvent(name, static_cast<uint16_t>(dataSize), static_cast<Hermes::Delivery>(delivery));
 	}
 
 	EventID RD_API getEventID(const char* name){
@@ -157,6 +179,22 @@ namespace RainDrop{
 		Hermes::unsubscribe(static_cast<Hermes::EventID>(id), MTcallback);
 	}
 
+	void RD_API subscribeEventBatch(EventID id, void(*FNcallback)(void*, uint32_t)){
+		Hermes::subscribeBatch(static_cast<Hermes::EventID>(id), FNcallback);
+	}
+
+	void RD_API subscribeEventBatch(EventID id, void* instance, void(*MTcallback)(void*, void*, uint32_t)){
+		Hermes::subscribeBatch(static_cast<Hermes::EventID>(id), instance, MTcallback);
+	}
+
+	void RD_API unsubscribeEventBatch(EventID id, void(*FNcallback)(void*, uint32_t)){
+		Hermes::unsubscribeBatch(static_cast<Hermes::EventID>(id), FNcallback);
+	}
+
+	void RD_API unsubscribeEventBatch(EventID id, void(*MTcallback)(void*, void*, uint32_t)){
+		Hermes::unsubscribeBatch(static_cast<Hermes::EventID>(id), MTcallback);
+	}
+
 	uint32_t RD_API getEventDataSize(const char* name){
 		return getEventDataSize(getEventID(name));
 	}
@@ -173,6 +211,23 @@ namespace RainDrop{
 		return Hermes::allocStack(static_cast<size_t>(size));
 	}
 
+	void* RD_API __eventAllocPayload(EventID id){
+		return Hermes::allocPayload(static_cast<Hermes::EventID>(id));
+	}
+
+	EventTimerID RD_API __scheduleEvent(EventID id, bool frames, double delay, double interval){
+		Hermes::Timeline timeline = frames ? Hermes::Timeline::Frames : Hermes::Timeline::Seconds;
+		return static_cast<EventTimerID>(Hermes::scheduleEvent(static_cast<Hermes::EventID>(id), timeline, delay, interval));
+	}
+
+	void* RD_API __eventTimerPayload(EventTimerID timer){
+		return Hermes::getTimerPayload(static_cast<Hermes::TimerID>(timer));
+	}
+
+	bool RD_API cancelEventTimer(EventTimerID timer){
+		return Hermes::cancelTimer(static_cast<Hermes::TimerID>(timer));
+	}
+
 	bool RD_API isKeyDown(Key key){
 		return getInstance().keyPressed[static_cast<int>(key)];
 	}
@@ -195,9 +250,90 @@ namespace RainDrop{
 
 	void RD_API updateEvents(){
 		poolEvents();
+		Odin::update();
 		Hermes::update();
 	}
 
+	void RD_API startEventRecording(const char* path){
+		try{
+			Hermes::startRecording(path);
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to start the event recording", err);
+		}
+	}
+
+	void RD_API stopEventRecording(){
+		Hermes::stopRecording();
+	}
+
+	uint64_t RD_API getEventRecordingDroppedCount(){
+		return Hermes::getDroppedRecordCount();
+	}
+
+	void RD_API startEventReplay(const char* path){
+		try{
+			startReplay(path);
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to start the event replay", err);
+		}
+	}
+
+	void RD_API stopEventReplay(){
+		stopReplay();
+	}
+
+	bool RD_API isEventReplaying(){
+		return Hermes::isReplaying();
+	}
+
+	EventStats RD_API getEventStats(EventID event){
+		Hermes::EventStats stats = Hermes::getEventStats(event);
+		return {stats.name, stats.id, stats.subscribers, stats.triggers, stats.coalesced, stats.payloadBytes, stats.callbackTime, stats.totalTriggers};
+	}
+
+	static_assert(sizeof(EventCallbackStats) == sizeof(Hermes::CallbackStats) && EVENT_LATENCY_BUCKET_COUNT == Hermes::LATENCY_BUCKET_COUNT, "the event callback stats are the Hermes ones");
+
+	size_t RD_API getEventCallbackStats(EventID event, EventCallbackStats* stats, size_t maxCount){
+		return Hermes::getCallbackStats(event, reinterpret_cast<Hermes::CallbackStats*>(stats), maxCount);
+	}
+
+	void RD_API setEventStatsDump(const char* path, EventStatsFormat format){
+		try{
+			Hermes::setStatsDump(path, static_cast<Hermes::StatsFormat>(format));
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to set the event stats dump", err);
+		}
+	}
+
+	// ====================================== Memory
+
+	static_assert(static_cast<int>(MemoryCategory::Render) == static_cast<int>(Horreum::Category::Render), "the memory categories must match the Horreum ones");
+
+	static void(*memoryBudgetCallback)(MemoryCategory, uint64_t, uint64_t, bool) = nullptr;
+
+	static void onMemoryBudget(Horreum::Category category, uint64_t liveBytes, uint64_t budget, bool hard){
+		auto callback = memoryBudgetCallback;
+		if (callback) callback(static_cast<MemoryCategory>(category), liveBytes, budget, hard);
+	}
+
+	MemoryStats RD_API getMemoryStats(MemoryCategory category){
+		Horreum::CategoryStats stats = Horreum::getCategoryStats(static_cast<Horreum::Category>(category));
+		return {stats.liveBytes, stats.peakBytes, stats.liveCount, stats.frameAllocations, stats.totalAllocations, stats.softBudget, stats.hardBudget};
+	}
+
+	void RD_API setMemoryBudget(MemoryCategory category, uint64_t softBudget, uint64_t hardBudget){
+		Horreum::setBudget(static_cast<Horreum::Category>(category), softBudget, hardBudget);
+	}
+
+	void RD_API setMemoryBudgetCallback(void(*callback)(MemoryCategory, uint64_t, uint64_t, bool)){
+		memoryBudgetCallback = callback;
+		Horreum::setBudgetCallback(callback ? onMemoryBudget : nullptr);
+	}
+
+	const char* RD_API getMemoryCategoryName(MemoryCategory category){
+		return Horreum::getCategoryName(static_cast<Horreum::Category>(category));
+	}
+
 
 	// ====================================== Render
 
@@ -206,6 +342,7 @@ namespace RainDrop{
 	}
 
 	void RD_API beginFrame(){
+		Horreum::beginFrame();
 		FoveaBeginFrame();
 	}
 
@@ -496,14 +633,90 @@ namespace RainDrop{
 		Odin::registerFactoryPtr(reinterpret_cast<Odin::Factory*>(factory));
 	}
 
-	void* RD_API getAsset(uint64_t typeID, const char* name, AssetData &data, uint16_t*& count, void (**removeAsset)(const char*)){
-		return Odin::getAssetPtr(name, typeID, *reinterpret_cast<Odin::Data*>(&data), count, removeAsset);
+	static_assert(sizeof(AssetHandle) == sizeof(Odin::Handle), "the asset handles are the Odin ones");
+	static_assert(sizeof(AssetSpan) == sizeof(Odin::Span), "the asset spans are the Odin ones");
+	static_assert(sizeof(AssetData) == sizeof(Odin::Data), "the asset data are the Odin ones");
+
+	AssetHandle RD_API acquireAsset(uint64_t typeID, const char* name, const AssetData &data){
+		try{
+			return Odin::acquireHandle(name, typeID, *reinterpret_cast<const Odin::Data*>(&data));
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to get the asset", err);
+		}
+	}
+
+	void RD_API addAssetDependency(AssetDependencies &dependencies, uint64_t typeID, const char* name, const AssetData &data){
+		reinterpret_cast<Odin::Dependencies*>(&dependencies)->add(name, typeID, *reinterpret_cast<const Odin::Data*>(&data));
+	}
+
+	void RD_API retainAsset(AssetHandle handle){
+		Odin::retainHandle(handle);
+	}
+
+	void RD_API releaseAsset(AssetHandle handle){
+		Odin::releaseHandle(handle);
+	}
+
+	void* RD_API getAssetPtr(AssetHandle handle){
+		return Odin::getAssetPtr(handle);
+	}
+
+	AssetHandle RD_API acquireAssetAsync(uint64_t typeID, const char* name, const AssetData &data, AssetLoadCallback callback, void* userData, AssetPriority priority){
+		try{
+			return Odin::acquireHandleAsync(name, typeID, *reinterpret_cast<const Odin::Data*>(&data), callback, userData, static_cast<Odin::Priority>(priority));
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to load the asset", err);
+		}
+	}
+
+	bool RD_API setAssetLoadPriority(const char* name, AssetPriority priority){
+		return Odin::setLoadPriority(name, static_cast<Odin::Priority>(priority));
+	}
+
+	bool RD_API cancelAssetLoad(const char* name){
+		return Odin::cancelLoad(name);
+	}
+
+	void RD_API setAssetFrameBudget(size_t bytes, uint32_t microseconds){
+		Odin::setFrameBudget(bytes, microseconds);
+	}
+
+	AssetState RD_API getAssetState(const char* name){
+		return static_cast<AssetState>(Odin::getAssetState(name));
 	}
 
 	void RD_API clearAssets(){
 		Odin::clear();
 	}
 
+	void RD_API mountAssetPack(const char* path){
+		try{
+			Odin::mountPack(path);
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to mount the asset pack", err);
+		}
+	}
+
+	void RD_API setAssetCacheBudget(size_t bytes){
+		Odin::setCacheBudget(bytes);
+	}
+
+	size_t RD_API getAssetCacheSize(){
+		return Odin::getCacheSize();
+	}
+
+	void RD_API watchAssets(const char* root, uint32_t debounceMilliseconds){
+		try{
+			Odin::watch(root, debounceMilliseconds);
+		} catch (const char* err){
+			RD_TRHOW_EXCEPT("failed to watch the assets", err);
+		}
+	}
+
+	void RD_API unwatchAssets(){
+		Odin::unwatch();
+	}
+
 	// ==========================================================
 	// ==                         SOUND                        ==
 	// ==========================================================
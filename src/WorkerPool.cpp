@@ -0,0 +1,136 @@
+#include "WorkerPool.hpp"
+#include "horreum/Horreum.hpp"
+#include <thread>
+
+WorkerPool::WorkerPool(uint32_t threadCount){
+	if (threadCount == 0){
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	pthread_mutex_init(&mutex, nullptr);
+	pthread_cond_init(&workCondition, nullptr);
+	pthread_cond_init(&doneCondition, nullptr);
+
+	jobCapacity = 64;
+	jobs = static_cast<Job*>(HRM_MALLOC(sizeof(Job) * jobCapacity));
+
+	this->threadCount = threadCount;
+	threads = static_cast<pthread_t*>(HRM_MALLOC(sizeof(pthread_t) * threadCount));
+	for (uint32_t i=0; i<threadCount; i++){
+		pthread_create(&threads[i], nullptr, &WorkerPool::workerThread, this);
+	}
+}
+
+WorkerPool::~WorkerPool(){
+	// the queued jobs are run before the threads exit
+	pthread_mutex_lock(&mutex);
+	running = false;
+	pthread_cond_broadcast(&workCondition);
+	pthread_mutex_unlock(&mutex);
+
+	for (uint32_t i=0; i<threadCount; i++){
+		pthread_join(threads[i], nullptr);
+	}
+
+	pthread_cond_destroy(&doneCondition);
+	pthread_cond_destroy(&workCondition);
+	pthread_mutex_destroy(&mutex);
+
+	HRM_FREE(threads);
+	HRM_FREE(jobs);
+}
+
+void WorkerPool::submit(Task task, void* data, Group* group){
+	if (group) group->pending.fetch_add(1, std::memory_order_relaxed);
+
+	pthread_mutex_lock(&mutex);
+
+	if (jobCount == jobCapacity){
+		// unroll the ring into the grown buffer
+		Job* grown = static_cast<Job*>(HRM_MALLOC(sizeof(Job) * jobCapacity * 2));
+		for (uint32_t i=0; i<jobCount; i++){
+			grown[i] = jobs[(jobStart + i) % jobCapacity];
+		}
+		HRM_FREE(jobs);
+		jobs = grown;
+		jobStart = 0;
+		jobCapacity *= 2;
+	}
+
+	Job &job = jobs[(jobStart + jobCount) % jobCapacity];
+	job.task = task;
+	job.data = data;
+	job.group = group;
+	jobCount++;
+
+	pthread_cond_signal(&workCondition);
+	pthread_mutex_unlock(&mutex);
+}
+
+WorkerPool::Job WorkerPool::take(uint32_t position){
+	Job job = jobs[(jobStart + position) % jobCapacity];
+
+	for (uint32_t i=position; i>0; i--){
+		jobs[(jobStart + i) % jobCapacity] = jobs[(jobStart + i - 1) % jobCapacity];
+	}
+
+	jobStart = (jobStart + 1) % jobCapacity;
+	jobCount--;
+	return job;
+}
+
+void WorkerPool::run(const Job &job){
+	job.task(job.data);
+
+	if (job.group && job.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1){
+		// lock so the waiting thread cannot miss the signal between its check and its wait
+		pthread_mutex_lock(&mutex);
+		pthread_cond_broadcast(&doneCondition);
+		pthread_mutex_unlock(&mutex);
+	}
+}
+
+void WorkerPool::wait(Group &group){
+	pthread_mutex_lock(&mutex);
+
+	while (group.pending.load(std::memory_order_acquire) != 0){
+		// help with the queued jobs of the group instead of sleeping
+		uint32_t position = 0;
+		while (position < jobCount && jobs[(jobStart + position) % jobCapacity].group != &group) position++;
+
+		if (position < jobCount){
+			Job job = take(position);
+			pthread_mutex_unlock(&mutex);
+			run(job);
+			pthread_mutex_lock(&mutex);
+			continue;
+		}
+
+		// the remaining jobs are running on the workers
+		pthread_cond_wait(&doneCondition, &mutex);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void* WorkerPool::workerThread(void* data){
+	WorkerPool* pool = static_cast<WorkerPool*>(data);
+
+	pthread_mutex_lock(&pool->mutex);
+	while (true){
+		while (pool->jobCount == 0 && pool->running){
+			pthread_cond_wait(&pool->workCondition, &pool->mutex);
+		}
+
+		if (pool->jobCount == 0) break;
+
+		Job job = pool->take(0);
+		pthread_mutex_unlock(&pool->mutex);
+		pool->run(job);
+		pthread_mutex_lock(&pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return nullptr;
+}
@@ -0,0 +1,133 @@
+// build an Odin asset pack from a directory, see include/odin/Pack.hpp for the layout
+// build with `make packer`, usage : odinPacker <directory> <output> [alignment]
+// the name of an asset is the path of its file from the directory argument, with '/' separators, ex: .data/images/spaceShips.png
+// the payloads are aligned on 16 bytes by default
+
+#include "Odin.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct File{
+	std::string name;
+	fs::path path;
+	PackEntry entry;
+};
+
+static uint64_t alignUp(uint64_t offset, uint64_t alignment){
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+static bool copyFile(const fs::path &path, FILE* output, uint64_t size){
+	FILE* input = fopen(path.string().c_str(), "rb");
+	if (!input) return false;
+
+	char buffer[64 * 1024];
+	uint64_t copied = 0;
+	while (copied < size){
+		size_t count = fread(buffer, 1, sizeof(buffer), input);
+		if (count == 0) break;
+		fwrite(buffer, 1, count, output);
+		copied += count;
+	}
+
+	fclose(input);
+	return copied == size;
+}
+
+int main(int argc, char** argv){
+	if (argc < 3){
+		fprintf(stderr, "usage : %s <directory> <output> [alignment]\n", argv[0]);
+		return 1;
+	}
+
+	fs::path directory = fs::path(argv[1]).lexically_normal();
+	uint32_t alignment = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 16;
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0){
+		fprintf(stderr, "the alignment must be a power of two\n");
+		return 1;
+	}
+
+	std::vector<File> files;
+	std::error_code error;
+	for (auto it = fs::recursive_directory_iterator(directory, error); !error && it != fs::recursive_directory_iterator(); it.increment(error)){
+		if (!it->is_regular_file()) continue;
+
+		File file;
+		file.path = it->path();
+		file.name = file.path.lexically_normal().generic_string();
+
+		std::string extension = file.path.extension().string();
+		if (!extension.empty()) extension.erase(0, 1);
+
+		file.entry.id = Odin::hashName(file.name.c_str());
+		file.entry.type = Odin::hashName(extension.c_str());
+		file.entry.size = fs::file_size(file.path);
+		files.push_back(file);
+	}
+
+	if (error){
+		fprintf(stderr, "failed to read %s : %s\n", directory.string().c_str(), error.message().c_str());
+		return 1;
+	}
+
+	// the runtime binary searches the ids
+	std::sort(files.begin(), files.end(), [](const File &a, const File &b){return a.entry.id < b.entry.id;});
+	for (size_t i=1; i<files.size(); i++){
+		if (files[i - 1].entry.id == files[i].entry.id){
+			fprintf(stderr, "name hash collision between %s and %s\n", files[i - 1].name.c_str(), files[i].name.c_str());
+			return 1;
+		}
+	}
+
+	PackHeader header;
+	header.magic = PackHeader::MAGIC;
+	header.version = PackHeader::FORMAT_VERSION;
+	header.entryCount = static_cast<uint32_t>(files.size());
+	header.alignment = alignment;
+	header.tocOffset = sizeof(PackHeader);
+
+	uint64_t offset = header.tocOffset + sizeof(PackEntry) * files.size();
+	for (File &file : files){
+		offset = alignUp(offset, alignment);
+		file.entry.offset = offset;
+		offset += file.entry.size;
+	}
+	header.size = offset;
+
+	FILE* output = fopen(argv[2], "wb");
+	if (!output){
+		fprintf(stderr, "failed to open %s\n", argv[2]);
+		return 1;
+	}
+
+	fwrite(&header, sizeof(header), 1, output);
+	for (const File &file : files){
+		fwrite(&file.entry, sizeof(PackEntry), 1, output);
+	}
+
+	static const char padding[4096] = {};
+	uint64_t position = header.tocOffset + sizeof(PackEntry) * files.size();
+	for (const File &file : files){
+		while (position < file.entry.offset){
+			size_t count = static_cast<size_t>(std::min<uint64_t>(file.entry.offset - position, sizeof(padding)));
+			fwrite(padding, 1, count, output);
+			position += count;
+		}
+
+		if (!copyFile(file.path, output, file.entry.size)){
+			fprintf(stderr, "failed to read %s\n", file.name.c_str());
+			fclose(output);
+			return 1;
+		}
+		position += file.entry.size;
+	}
+
+	fclose(output);
+	printf("%u assets, %llu bytes\n", header.entryCount, static_cast<unsigned long long>(header.size));
+	return 0;
+}